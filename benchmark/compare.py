@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""A/B comparison of solver builds and configurations.
+
+Runs two or more configurations over the same instances with several seeds
+and reports, against the first configuration (the baseline):
+  - solved counts, PAR-2 and the solved-count delta
+  - per-instance speedups (baseline time / time, median over seeds) and their geometric mean
+  - a Wilcoxon signed-rank test on the paired PAR-2 times (exact for small samples)
+  - any SAT/UNSAT disagreement between configurations (always a bug)
+
+A configuration is NAME=BINARY [OPTIONS...]. Seed 0 is the instance as is;
+seed s > 0 is a copy with the variables renamed and the clauses and literals
+shuffled deterministically, which works for every build (ver_1 takes no options).
+All configurations see the same copies, so runs are paired.
+
+Example:
+    python3 benchmark/compare.py \\
+        --config 'ver_1=cpu/cpp/ver_1/obj/main' \\
+        --config 'ver_2=cpu/cpp/ver_2/obj/main' \\
+        --config 'switch=cpu/cpp/ver_2/obj/main --mode=switch' \\
+        --cnf instances/ --seeds 3 --timeout 300 --out results/ab
+"""
+
+import argparse
+import math
+import os
+import statistics
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+import generate
+import harness
+
+
+def read_cnf(path):
+    """(variables, clauses) of a DIMACS file."""
+    variables, clauses, clause = 0, [], []
+    with open(path) as f:
+        for line in f:
+            if line.startswith('c') or not line.strip():
+                continue
+            if line.startswith('p'):
+                variables = int(line.split()[2])
+                continue
+            for tok in line.split():
+                lit = int(tok)
+                if lit == 0:
+                    clauses.append(clause)
+                    clause = []
+                else:
+                    clause.append(lit)
+    return variables, clauses
+
+
+def shuffled_copy(path, name, seed, directory):
+    """An equivalent instance with renamed variables and shuffled clauses (seed 0: the file itself).
+    The copy is directory/name.s<seed>.cnf, name being the instance key from collect()."""
+    if seed == 0:
+        return path
+    target = os.path.join(directory, '%s.s%d.cnf' % (name, seed))
+    if os.path.exists(target):
+        return target
+    variables, clauses = read_cnf(path)
+    rng = generate.SplitMix64(seed)
+
+    def shuffle(items):
+        for i in range(len(items) - 1, 0, -1):
+            j = rng.below(i + 1)
+            items[i], items[j] = items[j], items[i]
+
+    rename = list(range(1, variables + 1))
+    shuffle(rename)
+    rename = [0] + rename
+    for c in clauses:
+        c[:] = [rename[abs(lit)] if lit > 0 else -rename[abs(lit)] for lit in c]
+        shuffle(c)
+    shuffle(clauses)
+
+    os.makedirs(os.path.dirname(target), exist_ok=True)
+    with open(target + '.part', 'w') as f:
+        f.write('c %s shuffled with seed %d\np cnf %d %d\n' % (name, seed, variables, len(clauses)))
+        for c in clauses:
+            f.write(' '.join(map(str, c)) + ' 0\n')
+    os.rename(target + '.part', target)
+    return target
+
+
+def wilcoxon(a, b):
+    """Two-sided Wilcoxon signed-rank test of paired samples. Returns (n, W+, p)."""
+    d = [x - y for x, y in zip(a, b) if x != y]
+    n = len(d)
+    if n == 0:
+        return 0, 0.0, 1.0
+    # Ranks of |d| (average ranks for ties)
+    order = sorted(range(n), key=lambda i: abs(d[i]))
+    ranks = [0.0] * n
+    ties = []
+    i = 0
+    while i < n:
+        j = i
+        while j + 1 < n and abs(d[order[j + 1]]) == abs(d[order[i]]):
+            j += 1
+        for k in range(i, j + 1):
+            ranks[order[k]] = (i + j) / 2.0 + 1
+        ties.append(j - i + 1)
+        i = j + 1
+    w = sum(r for r, x in zip(ranks, d) if x > 0)
+
+    if n <= 30 and all(t == 1 for t in ties):
+        # Exact distribution of W+ by counting subsets of ranks 1..n
+        counts = [1] + [0] * (n * (n + 1) // 2)
+        for r in range(1, n + 1):
+            for s in range(len(counts) - 1, r - 1, -1):
+                counts[s] += counts[s - r]
+        total = 2 ** n
+        low = min(w, n * (n + 1) / 2 - w)
+        p = 2 * sum(counts[s] for s in range(int(low) + 1)) / total
+        return n, w, min(1.0, p)
+
+    # Normal approximation with tie and continuity corrections
+    mean = n * (n + 1) / 4.0
+    var = n * (n + 1) * (2 * n + 1) / 24.0 - sum(t ** 3 - t for t in ties) / 48.0
+    if var <= 0:
+        return n, w, 1.0
+    z = (abs(w - mean) - 0.5) / math.sqrt(var)
+    return n, w, min(1.0, math.erfc(max(z, 0) / math.sqrt(2)))
+
+
+def penalized(r, timeout):
+    return r['wall'] if r['status'] == 'ok' else 2 * timeout
+
+
+def parse_config(text):
+    name, _, command = text.partition('=')
+    parts = command.split()
+    if not name or not parts:
+        raise SystemExit('bad --config %r (expected NAME=BINARY [OPTIONS...])' % text)
+    return {'name': name, 'solver': os.path.abspath(parts[0]), 'args': parts[1:]}
+
+
+def collect(paths):
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            files += sorted(os.path.join(p, n) for n in os.listdir(p) if n.endswith('.cnf'))
+        else:
+            files.append(p)
+    return files
+
+
+def instance_names(files):
+    """{file: key} with the keys the paths relative to the common directory of all files.
+    Unlike basenames they stay unique when two --cnf directories hold files of the same name."""
+    files = list(dict.fromkeys(os.path.abspath(f) for f in files))
+    if not files:
+        return {}
+    root = os.path.commonpath([os.path.dirname(f) for f in files])
+    return {f: os.path.relpath(f, root) for f in files}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--config', action='append', required=True, help='NAME=BINARY [OPTIONS...] (repeatable, first is the baseline)')
+    ap.add_argument('--cnf', action='append', default=[], help='CNF file or directory (repeatable)')
+    ap.add_argument('--uri', action='append', default=[], help='URI list resolved through --cache (repeatable)')
+    ap.add_argument('--cache', help='local instance cache directory for --uri')
+    ap.add_argument('--seeds', type=int, default=1, help='seeds per instance (0 is the original instance)')
+    ap.add_argument('--dir', default='/tmp/sat-compare', help='directory of the shuffled copies')
+    ap.add_argument('--jobs', type=int, default=os.cpu_count(), help='parallel jobs')
+    ap.add_argument('--timeout', type=float, default=300, help='wall clock limit per job in seconds')
+    ap.add_argument('--memory', type=int, default=0, help='memory limit per job in MB (0: none)')
+    ap.add_argument('--alpha', type=float, default=0.05, help='significance level')
+    ap.add_argument('--out', default='results/compare', help='output prefix (writes .csv and .json)')
+    a = ap.parse_args()
+
+    configs = [parse_config(c) for c in a.config]
+    if len(configs) < 2:
+        raise SystemExit('at least two --config are needed')
+    files = collect(a.cnf)
+    if a.uri:
+        if not a.cache:
+            raise SystemExit('--uri needs --cache')
+        files += [c for c in (harness.lookup(u, a.cache) for p in a.uri for u in harness.read_uris(p)) if c]
+    if not files:
+        raise SystemExit('no instances')
+    instance_key = instance_names(files)
+    files = list(instance_key)
+
+    # Shuffled copies first (jobs share them)
+    copies = {(f, s): shuffled_copy(f, instance_key[f], s, a.dir) for f in files for s in range(a.seeds)}
+
+    # Jobs in a shuffled order, so slow phases of the machine do not hit one configuration only
+    jobs = [(c, f, s) for f in files for s in range(a.seeds) for c in range(len(configs))]
+    rng = generate.SplitMix64(len(jobs))
+    for i in range(len(jobs) - 1, 0, -1):
+        j = rng.below(i + 1)
+        jobs[i], jobs[j] = jobs[j], jobs[i]
+
+    def job(item):
+        c, f, s = item
+        r = harness.run_solver(configs[c]['solver'], configs[c]['args'], copies[(f, s)], a.timeout, a.memory)
+        r.update({'config': configs[c]['name'], 'instance': instance_key[f], 'seed': s})
+        return r
+
+    results = {}
+    with ThreadPoolExecutor(max_workers=a.jobs) as pool:
+        for n, r in enumerate(pool.map(job, jobs)):
+            results[(r['config'], r['instance'], r['seed'])] = r
+            print('[%d/%d] %s %s s%d %s %.2fs' % (n + 1, len(jobs), r['config'], r['instance'], r['seed'],
+                                                r['status'], r['wall']), file=sys.stderr)
+
+    names = [c['name'] for c in configs]
+    keys = sorted({(i, s) for (_, i, s) in results})
+    base = names[0]
+
+    # SAT/UNSAT disagreements
+    conflicts = []
+    for i, s in keys:
+        answers = {results[(n, i, s)]['result'] for n in names} & {'SATISFIABLE', 'UNSATISFIABLE'}
+        if len(answers) > 1:
+            conflicts.append({'instance': i, 'seed': s,
+                              'results': {n: results[(n, i, s)]['result'] for n in names}})
+
+    summary = {'configs': configs, 'instances': len(files), 'seeds': a.seeds, 'timeout': a.timeout,
+               'disagreements': conflicts, 'comparisons': []}
+    rows = []
+    for n in names:
+        runs = [results[(n, i, s)] for i, s in keys]
+        summary[n] = harness.summarize(runs, a.timeout)
+        rows += runs
+
+    print('%-16s %8s %8s %12s %10s %12s %10s %s' %
+          ('config', 'solved', 'delta', 'PAR-2', 'speedup', 'faster/slower', 'p-value', ''))
+    for n in names:
+        s = summary[n]
+        line = '%-16s %8d %8s %12.2f' % (n, s['solved'], '', s['par2'])
+        if n != base:
+            a_times = [penalized(results[(base, i, sd)], a.timeout) for i, sd in keys]
+            b_times = [penalized(results[(n, i, sd)], a.timeout) for i, sd in keys]
+            count, w, p = wilcoxon(a_times, b_times)
+            # Per instance: median over seeds of the speedup
+            speedups = []
+            for inst in sorted({i for i, _ in keys}):
+                ratios = [penalized(results[(base, inst, sd)], a.timeout) /
+                          max(penalized(results[(n, inst, sd)], a.timeout), 1e-3)
+                          for i, sd in keys if i == inst]
+                speedups.append({'instance': inst, 'speedup': statistics.median(ratios)})
+            geo = math.exp(statistics.mean(math.log(max(x['speedup'], 1e-9)) for x in speedups))
+            faster = sum(y < x for x, y in zip(a_times, b_times))
+            slower = sum(y > x for x, y in zip(a_times, b_times))
+            delta = s['solved'] - summary[base]['solved']
+            comparison = {'baseline': base, 'config': n, 'solved_delta': delta, 'geomean_speedup': geo,
+                          'faster': faster, 'slower': slower, 'wilcoxon_n': count, 'wilcoxon_w': w,
+                          'p_value': p, 'significant': p < a.alpha, 'speedups': speedups}
+            summary['comparisons'].append(comparison)
+            line = '%-16s %8d %+8d %12.2f %9.3fx %6d/%-6d %10.4f %s' % (
+                n, s['solved'], delta, s['par2'], geo, faster, slower, p,
+                ('significant' if p < a.alpha else 'not significant'))
+        print(line)
+    for c in conflicts:
+        print('DISAGREEMENT %s seed %d: %s' % (c['instance'], c['seed'], c['results']))
+
+    meta = {'configs': configs, 'seeds': a.seeds, 'timeout': a.timeout, 'memory_mb': a.memory,
+            'jobs': a.jobs, 'alpha': a.alpha}
+    for r in rows:
+        r['uri'] = '%s/s%d' % (r['instance'], r['seed'])
+        r['instance'] = '%s:%s' % (r['config'], r['instance'])
+    harness.write_results(a.out, meta, rows, summary)
+    sys.exit(1 if conflicts else 0)
+
+
+if __name__ == '__main__':
+    main()
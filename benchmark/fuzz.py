@@ -0,0 +1,434 @@
+#!/usr/bin/env python3
+"""Differential fuzzing of a solver build with model and proof checking.
+
+Every round generates a random CNF or mutates the last one (flipped signs,
+dropped, duplicated or added clauses, units, duplicate literals, tautologies).
+The generators are
+  - small random k-SAT near the threshold with mixed clause lengths
+  - random 3-SAT with clauses of 16-48 nearby variables (the long-clause path
+    of propagate() and, with --compress, compressed clauses)
+  - random 3-SAT at the threshold with 150-250 variables (thousands of
+    conflicts: restarts, mode switches, reduces on the harder ones)
+Each round
+  - runs the target with --model --proof=<file>
+  - checks SAT models against the original clauses
+  - checks UNSAT answers with drat-trim (--drat-trim, or found on PATH) or
+    else a forward RUP checker of the DRAT proof in this script; proofs over
+    --proof-limit or past --timeout are counted as unchecked
+  - compares the answer with a reference: another build (--reference) or,
+    without one and up to 70 variables, a small DPLL solver in this script
+Failing inputs are minimized (clauses, then literals, then variables are
+renumbered) and written to --failures.
+
+A build with lower search limits reaches reduces and mode switches in most
+rounds (see REDUCE_FIRST, MODE_FIRST and REPHASE_FIRST in solver.h):
+    make -C cpu/cpp/ver_2 FLAGS='-DREDUCE_FIRST=100 -DMODE_FIRST=50 -DREPHASE_FIRST=200'
+
+Example:
+    python3 benchmark/fuzz.py --target 'cpu/cpp/ver_2/obj/main --mode=switch' \\
+        --reference cpu/cpp/ver_1/obj/main --rounds 1000 --failures results/fuzz
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import generate
+
+RESULTS = ('SATISFIABLE', 'UNSATISFIABLE')
+DPLL_VARIABLES = 70     # Largest instance for the DPLL reference
+
+
+# ----------------------------------------------------------------------------
+# Instances
+
+def to_dimacs(variables, clauses):
+    return 'p cnf %d %d\n' % (variables, len(clauses)) + ''.join(
+        ' '.join(map(str, c)) + ' 0\n' for c in clauses)
+
+
+def random_clause(rng, low, high, k):
+    """k distinct variables of low..high with random signs."""
+    chosen = set()
+    while len(chosen) < k:
+        chosen.add(low + rng.below(high - low + 1))
+    return [v if rng.next() & 1 else -v for v in chosen]
+
+
+def random_instance(rng):
+    """3-62 variables, clauses of 2-5 literals."""
+    variables = 3 + rng.below(60)
+    return variables, [random_clause(rng, 1, variables, min(2 + rng.below(4), variables))
+                       for _ in range(int(variables * (3.0 + rng.below(250) / 100.0)))]
+
+
+def long_clause_instance(rng):
+    """Random 3-SAT near the threshold plus clauses of 16-48 literals over windows of nearby
+    variables (at least LONG_CLAUSE and COMPRESS_MIN_SIZE; small variable deltas compress)."""
+    variables = 60 + rng.below(140)
+    clauses = [random_clause(rng, 1, variables, 3) for _ in range(int(variables * (3.8 + rng.below(60) / 100.0)))]
+    for _ in range(variables // 4 + rng.below(variables // 2)):
+        k = 16 + rng.below(33)
+        low = 1 + rng.below(variables - k + 1)
+        clauses.append(random_clause(rng, low, min(variables, low + k - 1 + rng.below(k)), k))
+    return variables, clauses
+
+
+def large_instance(rng):
+    """Random 3-SAT at the threshold with 150-250 variables."""
+    variables = 150 + rng.below(101)
+    return variables, [random_clause(rng, 1, variables, 3) for _ in range(int(variables * 4.26))]
+
+
+def new_instance(rng):
+    kind = rng.below(8)
+    if kind < 5:
+        return random_instance(rng)
+    return long_clause_instance(rng) if kind < 7 else large_instance(rng)
+
+
+def mutate(rng, variables, clauses):
+    clauses = [list(c) for c in clauses]
+    for _ in range(1 + rng.below(4)):
+        kind = rng.below(7)
+        if kind == 0 and clauses:
+            c = clauses[rng.below(len(clauses))]
+            i = rng.below(len(c))
+            c[i] = -c[i]
+        elif kind == 1 and len(clauses) > 1:
+            clauses.pop(rng.below(len(clauses)))
+        elif kind == 2 and clauses:
+            clauses.append(list(clauses[rng.below(len(clauses))]))
+        elif kind == 3:
+            v = 1 + rng.below(variables)
+            clauses.append([v if rng.next() & 1 else -v])
+        elif kind == 4 and clauses:
+            # Duplicate literal
+            c = clauses[rng.below(len(clauses))]
+            c.insert(rng.below(len(c) + 1), c[rng.below(len(c))])
+        elif kind == 5 and clauses:
+            # Tautology
+            c = clauses[rng.below(len(clauses))]
+            c.insert(rng.below(len(c) + 1), -c[rng.below(len(c))])
+        else:
+            a, b = 1 + rng.below(variables), 1 + rng.below(variables)
+            if a != b:
+                clauses.append([a if rng.next() & 1 else -a, b if rng.next() & 1 else -b])
+    return variables, clauses
+
+
+# ----------------------------------------------------------------------------
+# Reference solver and checkers
+
+def dpll(variables, clauses):
+    """True if satisfiable (unit propagation and branching, for small instances)."""
+    def solve(clauses, assigned):
+        while True:
+            unit = None
+            simplified = []
+            for c in clauses:
+                if any(assigned.get(abs(l)) == (l > 0) for l in c):
+                    continue
+                rest = [l for l in c if abs(l) not in assigned]
+                if not rest:
+                    return False
+                if len(rest) == 1:
+                    unit = rest[0]
+                simplified.append(rest)
+            clauses = simplified
+            if unit is None:
+                break
+            assigned = dict(assigned)
+            assigned[abs(unit)] = unit > 0
+        if not clauses:
+            return True
+        v = abs(clauses[0][0])
+        return solve(clauses, {**assigned, v: True}) or solve(clauses, {**assigned, v: False})
+    return solve(clauses, {})
+
+
+def check_model(clauses, model):
+    """None if the model satisfies every clause, otherwise a message."""
+    true = {l for l in model if l != 0}
+    for c in clauses:
+        if not any(l in true for l in c):
+            return 'clause %s is falsified by the model' % c
+    return None
+
+
+def propagate(clauses_of, units, assumptions):
+    """Unit propagation from units and assumptions. True if it reaches a conflict."""
+    value = {}
+    queue = []
+
+    def assign(l):
+        v = value.get(abs(l))
+        if v is None:
+            value[abs(l)] = l > 0
+            queue.append(l)
+            return True
+        return v == (l > 0)
+
+    for l in list(units) + list(assumptions):
+        if not assign(l):
+            return True
+    i = 0
+    while i < len(queue):
+        false = -queue[i]
+        i += 1
+        for c in clauses_of.get(false, ()):
+            unassigned = None
+            count = 0
+            satisfied = False
+            for l in c:
+                v = value.get(abs(l))
+                if v is None:
+                    unassigned = l
+                    count += 1
+                elif v == (l > 0):
+                    satisfied = True
+                    break
+            if satisfied:
+                continue
+            if count == 0:
+                return True
+            if count == 1 and not assign(unassigned):
+                return True
+    return False
+
+
+class Unchecked(Exception):
+    """The proof is too large or the check ran out of time."""
+
+
+def check_proof(clauses, proof_path, deadline=None):
+    """Forward RUP check of a DRAT proof. None if it derives the empty clause, otherwise a message.
+    Raises Unchecked past the deadline (time.monotonic())."""
+    db = {}             # clause (sorted tuple) -> count
+    clauses_of = {}     # literal -> list of clauses
+    units = []
+
+    def add(c):
+        key = tuple(sorted(set(c)))
+        db[key] = db.get(key, 0) + 1
+        if len(key) == 1:
+            units.append(key[0])
+        for l in key:
+            clauses_of.setdefault(l, []).append(key)
+
+    def delete(c):
+        key = tuple(sorted(set(c)))
+        if db.get(key, 0) == 0:
+            return
+        db[key] -= 1
+        if len(key) == 1:
+            return      # Units are kept, as drat-trim does
+        for l in key:
+            clauses_of[l].remove(key)
+
+    for c in clauses:
+        if not c:
+            return None
+        add(c)
+    with open(proof_path) as f:
+        for n, line in enumerate(f, 1):
+            if deadline and n % 64 == 0 and time.monotonic() > deadline:
+                raise Unchecked('RUP check past --timeout at line %d' % n)
+            tokens = line.split()
+            if not tokens:
+                continue
+            deleted = tokens[0] == 'd'
+            lits = [int(t) for t in tokens[deleted:]]
+            if not lits or lits[-1] != 0:
+                return 'line %d: malformed' % n
+            lits = lits[:-1]
+            if deleted:
+                delete(lits)
+                continue
+            if not propagate(clauses_of, units, [-l for l in lits]):
+                return 'line %d: lemma %s is not RUP' % (n, lits)
+            if not lits:
+                return None
+            add(lits)
+    return 'the proof does not derive the empty clause'
+
+
+# ----------------------------------------------------------------------------
+# Running solvers
+
+def run(command, cnf, extra=(), timeout=60):
+    """(result, model) of a solver run."""
+    try:
+        out = subprocess.run(command + list(extra) + [cnf], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             timeout=timeout, universal_newlines=True).stdout
+    except subprocess.TimeoutExpired:
+        return 'TIMEOUT', None
+    result, model = 'UNKNOWN', None
+    for line in out.splitlines():
+        line = line.strip()
+        if line.startswith('s '):
+            line = line[2:]
+        if line in RESULTS or line == 'UNSOLVED':
+            result = line
+        elif result == 'SATISFIABLE' and model is None and line.endswith(' 0'):
+            tokens = line[2:].split() if line.startswith('v ') else line.split()
+            try:
+                model = [int(t) for t in tokens]
+            except ValueError:
+                pass
+    return result, model
+
+
+class Fuzzer:
+    def __init__(self, a, workdir):
+        self.target = a.target.split()
+        self.reference = a.reference.split() if a.reference else None
+        self.drat_trim = a.drat_trim or shutil.which('drat-trim')
+        self.proof_limit = a.proof_limit * 1000000
+        self.timeout = a.timeout
+        self.workdir = workdir
+        self.result = None      # Answer of the target in the last run
+        self.unchecked = None   # Why the last UNSAT answer was not checked (None: it was)
+        self.unreferenced = False   # The last answer was not compared with a reference
+
+    def failure(self, variables, clauses):
+        """None if the target behaves on this instance, otherwise what went wrong."""
+        cnf = os.path.join(self.workdir, 'input.cnf')
+        proof = os.path.join(self.workdir, 'proof.drat')
+        with open(cnf, 'w') as f:
+            f.write(to_dimacs(variables, clauses))
+        result, model = run(self.target, cnf, ['--model', '--proof=' + proof], self.timeout)
+        self.result = result
+        self.unchecked = None
+        self.unreferenced = False
+        if result not in RESULTS:
+            return 'target: %s' % result
+
+        if self.reference:
+            expected, _ = run(self.reference, cnf, (), self.timeout)
+        elif variables <= DPLL_VARIABLES:
+            expected = 'SATISFIABLE' if dpll(variables, clauses) else 'UNSATISFIABLE'
+        else:
+            expected = None
+        self.unreferenced = expected not in RESULTS
+        if expected in RESULTS and expected != result:
+            return 'target %s, reference %s' % (result, expected)
+
+        if result == 'SATISFIABLE':
+            if model is None:
+                return 'no model'
+            return check_model(clauses, model)
+        if self.drat_trim:
+            try:
+                out = subprocess.run([self.drat_trim, cnf, proof, '-t', str(max(1, int(self.timeout)))],
+                                     stdout=subprocess.PIPE, universal_newlines=True,
+                                     timeout=self.timeout + 10).stdout
+            except subprocess.TimeoutExpired:
+                out = ''
+            if 's VERIFIED' in out:
+                return None
+            if 's NOT VERIFIED' in out:
+                return 'drat-trim: proof not verified'
+            self.unchecked = 'drat-trim past --timeout'
+            return None
+        size = os.path.getsize(proof)
+        if size > self.proof_limit:
+            self.unchecked = 'proof of %d bytes over --proof-limit' % size
+            return None
+        try:
+            return check_proof(clauses, proof, time.monotonic() + self.timeout)
+        except Unchecked as e:
+            self.unchecked = str(e)
+            return None
+
+    def minimize(self, variables, clauses):
+        """Delta debugging: drop chunks of clauses, then literals, while the failure persists."""
+        chunk = max(1, len(clauses) // 2)
+        while chunk >= 1:
+            i = 0
+            while i < len(clauses):
+                candidate = clauses[:i] + clauses[i + chunk:]
+                if candidate and self.failure(variables, candidate):
+                    clauses = candidate
+                else:
+                    i += chunk
+            chunk //= 2
+        for ci in range(len(clauses)):
+            li = 0
+            while li < len(clauses[ci]) and len(clauses[ci]) > 1:
+                candidate = [list(c) for c in clauses]
+                candidate[ci].pop(li)
+                if self.failure(variables, candidate):
+                    clauses = candidate
+                else:
+                    li += 1
+        # Renumber the variables that are left
+        used = sorted({abs(l) for c in clauses for l in c})
+        rename = {v: i + 1 for i, v in enumerate(used)}
+        renamed = [[rename[abs(l)] if l > 0 else -rename[abs(l)] for l in c] for c in clauses]
+        if self.failure(len(used), renamed):
+            return len(used), renamed
+        return variables, clauses
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--target', required=True, help='solver under test with options (needs --model and --proof)')
+    ap.add_argument('--reference', help='reference solver with options (default: DPLL in this script)')
+    ap.add_argument('--drat-trim', help='drat-trim binary to check proofs (default: drat-trim on PATH, '
+                    'otherwise the RUP checker in this script)')
+    ap.add_argument('--proof-limit', type=float, default=2, help='largest proof in MB for the RUP checker in this script')
+    ap.add_argument('--rounds', type=int, default=500)
+    ap.add_argument('--seed', type=int, default=1)
+    ap.add_argument('--timeout', type=float, default=60, help='seconds per solver run')
+    ap.add_argument('--failures', default='results/fuzz', help='directory of the minimized failing inputs')
+    ap.add_argument('--keep-going', action='store_true', help='continue after a failure')
+    a = ap.parse_args()
+
+    rng = generate.SplitMix64(a.seed)
+    found = unchecked = unreferenced = 0
+    answers = {}
+    with tempfile.TemporaryDirectory() as workdir:
+        fuzzer = Fuzzer(a, workdir)
+        last = None
+        for n in range(1, a.rounds + 1):
+            if last is not None and rng.below(2):
+                variables, clauses = mutate(rng, *last)
+            else:
+                variables, clauses = new_instance(rng)
+            last = (variables, clauses)
+            problem = fuzzer.failure(variables, clauses)
+            answers[fuzzer.result] = answers.get(fuzzer.result, 0) + 1
+            unreferenced += fuzzer.unreferenced
+            if fuzzer.unchecked:
+                unchecked += 1
+                print('c round %d: UNSAT proof unchecked (%s)' % (n, fuzzer.unchecked), file=sys.stderr)
+            if n % 50 == 0:
+                print('c round %d, failures %d' % (n, found), file=sys.stderr)
+            if not problem:
+                continue
+
+            found += 1
+            variables, clauses = fuzzer.minimize(variables, clauses)
+            problem = fuzzer.failure(variables, clauses) or problem
+            os.makedirs(a.failures, exist_ok=True)
+            path = os.path.join(a.failures, 'seed%d_round%d.cnf' % (a.seed, n))
+            with open(path, 'w') as f:
+                f.write('c %s\n' % problem + to_dimacs(variables, clauses))
+            print('FAIL round %d: %s (%d variables, %d clauses) -> %s' %
+                  (n, problem, variables, len(clauses), path))
+            if not a.keep_going:
+                break
+    print('Rounds: %d (%s), failures: %d, unchecked proofs: %d, without reference: %d' %
+          (n, ', '.join('%s %d' % kv for kv in sorted(answers.items())), found, unchecked, unreferenced))
+    if not fuzzer.drat_trim:
+        print('c proofs checked with the RUP checker of this script (drat-trim is not on PATH)')
+    sys.exit(1 if found else 0)
+
+
+if __name__ == '__main__':
+    main()
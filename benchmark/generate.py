@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Deterministic random k-SAT generator.
+
+Uniform random k-SAT: every clause has k distinct variables chosen uniformly
+and random signs. Planted: a hidden assignment is drawn first and clauses it
+falsifies are redrawn, so every instance is satisfiable.
+
+The same (k, vars, ratio, seed, planted) always gives the same file: the
+generator uses its own SplitMix64 stream instead of Python's random module.
+
+Examples:
+    python3 benchmark/generate.py --vars 300 --ratio 4.26 --seed 1 > uf300.cnf
+    python3 benchmark/generate.py --vars 1000 --ratio 4.2 --planted --dir /tmp/cnf
+"""
+
+import argparse
+import os
+import sys
+
+MASK = (1 << 64) - 1
+
+
+class SplitMix64:
+    def __init__(self, seed):
+        self.state = seed & MASK
+
+    def next(self):
+        self.state = (self.state + 0x9E3779B97F4A7C15) & MASK
+        z = self.state
+        z = ((z ^ (z >> 30)) * 0xBF58476D1CE4E5B9) & MASK
+        z = ((z ^ (z >> 27)) * 0x94D049BB133111EB) & MASK
+        return z ^ (z >> 31)
+
+    def below(self, n):
+        """Uniform integer in [0, n) without modulo bias."""
+        limit = MASK - (MASK + 1) % n
+        while True:
+            x = self.next()
+            if x <= limit:
+                return x % n
+
+
+def instance_name(k, variables, ratio, seed, planted=False):
+    return 'k%d_n%d_r%g_s%d%s.cnf' % (k, variables, ratio, seed, '_planted' if planted else '')
+
+
+def generate(k, variables, ratio, seed, planted=False):
+    """DIMACS text of one instance."""
+    if k > variables:
+        raise ValueError('k must not exceed the number of variables')
+    rng = SplitMix64(seed * 1000003 + variables * 31 + k)
+    clauses = int(round(variables * ratio))
+    hidden = [rng.next() & 1 for _ in range(variables + 1)] if planted else None
+
+    lines = ['c random %d-SAT, %d variables, ratio %g, seed %d%s' %
+             (k, variables, ratio, seed, ', planted' if planted else ''),
+             'p cnf %d %d' % (variables, clauses)]
+    for _ in range(clauses):
+        while True:
+            chosen = set()
+            while len(chosen) < k:
+                chosen.add(1 + rng.below(variables))
+            clause = [v if rng.next() & 1 else -v for v in sorted(chosen)]
+            # A clause is satisfied if one literal agrees with the hidden assignment
+            if hidden is None or any((lit > 0) == (hidden[abs(lit)] == 1) for lit in clause):
+                break
+        lines.append(' '.join(map(str, clause)) + ' 0')
+    return '\n'.join(lines) + '\n'
+
+
+def write_instance(directory, k, variables, ratio, seed, planted=False):
+    """Generate into a directory (kept if it already exists). Returns the path."""
+    path = os.path.join(directory, instance_name(k, variables, ratio, seed, planted))
+    if not os.path.exists(path):
+        os.makedirs(directory, exist_ok=True)
+        with open(path + '.part', 'w') as f:
+            f.write(generate(k, variables, ratio, seed, planted))
+        os.rename(path + '.part', path)
+    return path
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--k', type=int, default=3, help='literals per clause')
+    ap.add_argument('--vars', type=int, required=True, help='number of variables')
+    ap.add_argument('--ratio', type=float, default=4.26, help='clauses per variable')
+    ap.add_argument('--seed', type=int, default=1)
+    ap.add_argument('--count', type=int, default=1, help='instances with seeds seed, seed+1, ...')
+    ap.add_argument('--planted', action='store_true', help='satisfiable by construction')
+    ap.add_argument('--dir', help='write files into this directory instead of stdout')
+    a = ap.parse_args()
+
+    for seed in range(a.seed, a.seed + a.count):
+        if a.dir:
+            print(write_instance(a.dir, a.k, a.vars, a.ratio, seed, a.planted))
+        else:
+            sys.stdout.write(generate(a.k, a.vars, a.ratio, seed, a.planted))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""Benchmark harness for the SAT Competition URI lists.
+
+Maps every URI of a list (e.g. track_main_2023.uri) to an instance in a
+local cache directory, runs a solver build over the instances in parallel
+with per-job time and memory limits, and writes per-instance results and
+a summary (solved counts, PAR-2) as CSV and JSON.
+
+The cache is keyed by the hash in the URI
+(https://gbd.iti.kit.edu/file/<hash>/ or
+http://benchmark-database.de/file/<hash>). Any file in the cache whose name
+starts with the hash is used; .xz/.gz/.bz2 files are decompressed once to
+<hash>.cnf next to them. --fetch downloads missing instances; without it
+no network access is needed.
+
+Note that the solver stops by itself after 2000 s of CPU time (UNSOLVED).
+
+Example:
+    python3 benchmark/harness.py --solver cpu/cpp/ver_2/obj/main \\
+        --uri benchmark/track_main_2023.uri --cache ~/sat-cache \\
+        --jobs 8 --timeout 5000 --memory 32000 --out results/ver_2
+"""
+
+import argparse
+import bz2
+import csv
+import gzip
+import json
+import lzma
+import os
+import re
+import shutil
+import signal
+import sys
+import tempfile
+import time
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+
+COMPRESSED = {'.xz': lzma.open, '.gz': gzip.open, '.bz2': bz2.open}
+RESULTS = ('SATISFIABLE', 'UNSATISFIABLE', 'UNSOLVED')
+
+
+def read_uris(path):
+    with open(path) as f:
+        return [line.strip() for line in f if line.strip()]
+
+
+def uri_hash(uri):
+    """The instance hash of a GBD URI (or the last path component)."""
+    parts = [p for p in uri.split('/') if p]
+    return parts[-1]
+
+
+def fetch(uri, cache):
+    """Download an instance into the cache (GBD serves xz-compressed CNF)."""
+    target = os.path.join(cache, uri_hash(uri) + '.cnf.xz')
+    with urllib.request.urlopen(uri) as src, open(target + '.part', 'wb') as dst:
+        shutil.copyfileobj(src, dst)
+    os.rename(target + '.part', target)
+
+
+def lookup(uri, cache, do_fetch=False):
+    """Path of the plain CNF for a URI in the cache, or None if missing."""
+    h = uri_hash(uri)
+    plain = os.path.join(cache, h + '.cnf')
+    if os.path.exists(plain):
+        return plain
+    candidates = [n for n in os.listdir(cache) if n.startswith(h) and not n.endswith('.part')]
+    if not candidates and do_fetch:
+        fetch(uri, cache)
+        candidates = [n for n in os.listdir(cache) if n.startswith(h) and not n.endswith('.part')]
+    for name in candidates:
+        path = os.path.join(cache, name)
+        for ext, opener in COMPRESSED.items():
+            if name.endswith(ext):
+                with opener(path, 'rb') as src, open(plain + '.part', 'wb') as dst:
+                    shutil.copyfileobj(src, dst)
+                os.rename(plain + '.part', plain)
+                return plain
+        if name.endswith('.cnf'):
+            return path
+    return None
+
+
+def parse_output(text):
+    """Result and 'Key: number' statistics printed by the solver."""
+    result = 'UNKNOWN'
+    stats = {}
+    for line in text.splitlines():
+        line = line.strip()
+        if line.startswith('s '):
+            line = line[2:]
+        if line in RESULTS:
+            result = line
+            continue
+        m = re.match(r'^([A-Za-z][A-Za-z0-9 ()/_-]*):\s*(-?[0-9.]+(?:e[-+]?[0-9]+)?)$', line)
+        if m:
+            key = m.group(1).strip().lower().replace(' ', '_').replace('(', '').replace(')', '')
+            stats[key] = float(m.group(2)) if '.' in m.group(2) or 'e' in m.group(2) else int(m.group(2))
+    return result, stats
+
+
+def high_water_mark(pid):
+    """Peak resident memory (kB) of a running process since its exec."""
+    try:
+        with open('/proc/%d/status' % pid) as f:
+            for line in f:
+                if line.startswith('VmHWM:'):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return 0
+
+
+def run_solver(solver, args, cnf, timeout, memory_mb):
+    """Run one job. Returns a dict with status, result, wall/cpu time, peak memory and statistics.
+
+    status is 'ok' (SATISFIABLE/UNSATISFIABLE), 'unsolved', 'timeout', 'memout' or 'error'.
+    """
+    # Limits are set by a shell right before exec
+    limits = []
+    if memory_mb:
+        limits.append('ulimit -v %d' % (memory_mb * 1024))
+    if timeout:
+        # Hard CPU limit slightly above the wall clock limit
+        limits.append('ulimit -t %d' % (int(timeout) + 5))
+    command = ['/bin/sh', '-c', '; '.join(limits + ['exec "$0" "$@"']), solver] + args + [cnf]
+
+    with tempfile.TemporaryFile(mode='w+') as out:
+        start = time.time()
+        pid = os.posix_spawn(command[0], command, os.environ, setsid=True,
+                             file_actions=[(os.POSIX_SPAWN_DUP2, out.fileno(), 1),
+                                           (os.POSIX_SPAWN_DUP2, out.fileno(), 2)])
+        killed = False
+        peak_kb = 0
+        while True:
+            # wait4 gives the resource usage of this job only
+            done, status, usage = os.wait4(pid, os.WNOHANG)
+            if done:
+                break
+            peak_kb = max(peak_kb, high_water_mark(pid))
+            elapsed = time.time() - start
+            if timeout and elapsed > timeout and not killed:
+                # SIGTERM lets the solver print its statistics, SIGKILL follows after a grace period
+                os.killpg(pid, signal.SIGTERM)
+                killed = True
+            elif killed and elapsed > timeout + 5:
+                os.killpg(pid, signal.SIGKILL)
+            time.sleep(0.01)
+        wall = time.time() - start
+        out.seek(0)
+        text = out.read()
+
+    result, stats = parse_output(text)
+    cpu = usage.ru_utime + usage.ru_stime
+    # ru_maxrss also counts the memory of this process before exec,
+    # so the high water mark of the solver itself is preferred
+    peak_mb = (peak_kb or usage.ru_maxrss) / 1024.0
+    if result in ('SATISFIABLE', 'UNSATISFIABLE'):
+        state = 'ok'
+    elif killed or (os.WIFSIGNALED(status) and os.WTERMSIG(status) in (signal.SIGXCPU, signal.SIGKILL)):
+        state = 'timeout'
+    elif memory_mb and (peak_mb >= 0.95 * memory_mb or 'bad_alloc' in text):
+        state = 'memout'
+    elif result == 'UNSOLVED':
+        state = 'unsolved'
+    else:
+        state = 'error'
+    return {'status': state, 'result': result, 'wall': round(wall, 3), 'cpu': round(cpu, 3),
+            'memory_mb': round(peak_mb, 1), 'exit': status, 'stats': stats}
+
+
+def par2(rows, timeout):
+    """PAR-2: solved instances count their runtime, the others twice the timeout."""
+    total = sum(r['wall'] if r['status'] == 'ok' else 2 * timeout for r in rows)
+    return total, (total / len(rows) if rows else 0.0)
+
+
+def summarize(rows, timeout):
+    solved = [r for r in rows if r['status'] == 'ok']
+    total, mean = par2(rows, timeout)
+    return {
+        'instances': len(rows),
+        'solved': len(solved),
+        'sat': sum(r['result'] == 'SATISFIABLE' for r in solved),
+        'unsat': sum(r['result'] == 'UNSATISFIABLE' for r in solved),
+        'timeout': sum(r['status'] == 'timeout' for r in rows),
+        'memout': sum(r['status'] == 'memout' for r in rows),
+        'unsolved': sum(r['status'] == 'unsolved' for r in rows),
+        'error': sum(r['status'] == 'error' for r in rows),
+        'par2': round(total, 3),
+        'par2_mean': round(mean, 3),
+    }
+
+
+def write_results(prefix, meta, rows, summary):
+    directory = os.path.dirname(prefix)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    keys = sorted({k for r in rows for k in r['stats']})
+    with open(prefix + '.csv', 'w', newline='') as f:
+        w = csv.writer(f)
+        w.writerow(['instance', 'uri', 'status', 'result', 'wall', 'cpu', 'memory_mb'] + keys)
+        for r in rows:
+            w.writerow([r['instance'], r['uri'], r['status'], r['result'], r['wall'], r['cpu'],
+                        r['memory_mb']] + [r['stats'].get(k, '') for k in keys])
+    with open(prefix + '.json', 'w') as f:
+        json.dump({'meta': meta, 'summary': summary, 'instances': rows}, f, indent=1)
+
+
+def run_set(solver, args, instances, jobs, timeout, memory_mb, progress=True):
+    """Run a solver over (uri, cnf) pairs in parallel. Missing instances are skipped."""
+    present = [(u, c) for u, c in instances if c]
+
+    def job(item):
+        uri, cnf = item
+        r = run_solver(solver, args, cnf, timeout, memory_mb)
+        r['uri'] = uri
+        r['instance'] = os.path.basename(cnf)
+        return r
+
+    rows = []
+    with ThreadPoolExecutor(max_workers=jobs) as pool:
+        for i, r in enumerate(pool.map(job, present)):
+            rows.append(r)
+            if progress:
+                print('[%d/%d] %s %s %s %.2fs' % (i + 1, len(present), r['instance'], r['status'],
+                                                r['result'], r['wall']), file=sys.stderr)
+    return rows
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--solver', required=True, help='solver binary')
+    ap.add_argument('--args', default='', help='solver options, e.g. --args="--mode=switch"')
+    ap.add_argument('--uri', action='append', required=True, help='URI list (repeatable)')
+    ap.add_argument('--cache', required=True, help='local instance cache directory')
+    ap.add_argument('--fetch', action='store_true', help='download missing instances into the cache')
+    ap.add_argument('--jobs', type=int, default=os.cpu_count(), help='parallel jobs')
+    ap.add_argument('--timeout', type=float, default=5000, help='wall clock limit per job in seconds')
+    ap.add_argument('--memory', type=int, default=0, help='memory limit per job in MB (0: none)')
+    ap.add_argument('--limit', type=int, default=0, help='only the first N instances')
+    ap.add_argument('--out', default='results/run', help='output prefix (writes .csv and .json)')
+    a = ap.parse_args()
+
+    os.makedirs(a.cache, exist_ok=True)
+    uris = [u for path in a.uri for u in read_uris(path)]
+    if a.limit:
+        uris = uris[:a.limit]
+    instances = [(u, lookup(u, a.cache, a.fetch)) for u in uris]
+    missing = [u for u, c in instances if not c]
+    if missing:
+        print('c %d of %d instances are not in the cache (use --fetch)' % (len(missing), len(uris)),
+              file=sys.stderr)
+
+    args = a.args.split()
+    rows = run_set(os.path.abspath(a.solver), args, instances, a.jobs, a.timeout, a.memory)
+    summary = summarize(rows, a.timeout)
+    summary['missing'] = len(missing)
+    meta = {'solver': a.solver, 'args': args, 'uri': a.uri, 'timeout': a.timeout,
+            'memory_mb': a.memory, 'jobs': a.jobs, 'date': time.strftime('%Y-%m-%d %H:%M:%S')}
+    write_results(a.out, meta, rows, summary)
+
+    print('Instances: %d (missing %d)' % (summary['instances'], len(missing)))
+    print('Solved: %d (SAT %d, UNSAT %d)' % (summary['solved'], summary['sat'], summary['unsat']))
+    print('Timeout: %d, Memout: %d, Unsolved: %d, Error: %d' %
+          (summary['timeout'], summary['memout'], summary['unsolved'], summary['error']))
+    print('PAR-2: %.2f (mean %.2f)' % (summary['par2'], summary['par2_mean']))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Scaling suite on generated random k-SAT instances.
+
+Generates instances with benchmark/generate.py for every size (number of
+variables) and seed, runs the solver over them with the limits of
+harness.py, and reports the runtime curve: per size the solved count,
+median and mean wall time, and median conflicts, plus the growth of the
+median time per added variable (least squares fit of log2(time)).
+No download is needed, so the suite suits regression testing.
+
+Example:
+    python3 benchmark/scaling.py --solver cpu/cpp/ver_2/obj/main \\
+        --sizes 100,150,200,250,300 --ratio 4.26 --seeds 10 --timeout 60 --out results/scaling
+"""
+
+import argparse
+import math
+import os
+import statistics
+
+import generate
+import harness
+
+
+def fit_growth(points):
+    """Slope of log2(time) over variables: doublings of the runtime per added variable."""
+    pts = [(n, math.log2(t)) for n, t in points if t > 0]
+    if len(pts) < 2:
+        return None
+    mx = sum(n for n, _ in pts) / len(pts)
+    my = sum(y for _, y in pts) / len(pts)
+    den = sum((n - mx) ** 2 for n, _ in pts)
+    return sum((n - mx) * (y - my) for n, y in pts) / den if den else None
+
+
+def summarize_size(n, rows, timeout):
+    solved = [r for r in rows if r['status'] == 'ok']
+    # Unsolved runs count as the timeout, so the median stays meaningful
+    times = [r['wall'] if r['status'] == 'ok' else timeout for r in rows]
+    conflicts = [r['stats']['conflicts'] for r in rows if 'conflicts' in r['stats']]
+    return {
+        'vars': n,
+        'instances': len(rows),
+        'solved': len(solved),
+        'sat': sum(r['result'] == 'SATISFIABLE' for r in solved),
+        'unsat': sum(r['result'] == 'UNSATISFIABLE' for r in solved),
+        'median_wall': round(statistics.median(times), 4) if times else 0,
+        'mean_wall': round(statistics.mean(times), 4) if times else 0,
+        'median_conflicts': statistics.median(conflicts) if conflicts else 0,
+        'par2': round(harness.par2(rows, timeout)[0], 3),
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--solver', required=True, help='solver binary')
+    ap.add_argument('--args', default='', help='solver options, e.g. --args="--mode=switch"')
+    ap.add_argument('--sizes', default='100,150,200,250,300', help='comma separated numbers of variables')
+    ap.add_argument('--ratio', type=float, default=4.26, help='clauses per variable')
+    ap.add_argument('--k', type=int, default=3, help='literals per clause')
+    ap.add_argument('--seeds', type=int, default=10, help='instances per size')
+    ap.add_argument('--planted', action='store_true', help='satisfiable instances with a hidden solution')
+    ap.add_argument('--dir', default='/tmp/sat-scaling', help='directory of the generated instances')
+    ap.add_argument('--jobs', type=int, default=os.cpu_count(), help='parallel jobs')
+    ap.add_argument('--timeout', type=float, default=60, help='wall clock limit per job in seconds')
+    ap.add_argument('--memory', type=int, default=0, help='memory limit per job in MB (0: none)')
+    ap.add_argument('--out', default='results/scaling', help='output prefix (writes .csv and .json)')
+    a = ap.parse_args()
+
+    sizes = [int(s) for s in a.sizes.split(',') if s]
+    instances = []
+    for n in sizes:
+        for seed in range(1, a.seeds + 1):
+            path = generate.write_instance(a.dir, a.k, n, a.ratio, seed, a.planted)
+            instances.append(('k%d/n%d/r%g/s%d' % (a.k, n, a.ratio, seed), path))
+
+    args = a.args.split()
+    rows = harness.run_set(os.path.abspath(a.solver), args, instances, a.jobs, a.timeout, a.memory)
+    for r in rows:
+        r['vars'] = int(r['uri'].split('/')[1][1:])
+
+    curve = [summarize_size(n, [r for r in rows if r['vars'] == n], a.timeout) for n in sizes]
+    growth = fit_growth([(c['vars'], c['median_wall']) for c in curve])
+
+    meta = {'solver': a.solver, 'args': args, 'k': a.k, 'ratio': a.ratio, 'seeds': a.seeds,
+            'planted': a.planted, 'timeout': a.timeout, 'memory_mb': a.memory, 'jobs': a.jobs}
+    summary = harness.summarize(rows, a.timeout)
+    summary['curve'] = curve
+    summary['log2_time_per_var'] = growth
+    harness.write_results(a.out, meta, rows, summary)
+
+    print('%8s %9s %7s %5s %6s %12s %12s %16s' %
+          ('vars', 'instances', 'solved', 'sat', 'unsat', 'median (s)', 'mean (s)', 'median conflicts'))
+    for c in curve:
+        print('%8d %9d %7d %5d %6d %12.4f %12.4f %16d' %
+              (c['vars'], c['instances'], c['solved'], c['sat'], c['unsat'],
+               c['median_wall'], c['mean_wall'], c['median_conflicts']))
+    if growth is not None:
+        print('Growth: median time x%.3f per 100 variables' % (2 ** (100 * growth)))
+    print('PAR-2: %.2f' % summary['par2'])
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,56 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+// Helpers shared by the microbenchmarks (and the checks in ../test)
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+
+// Elapsed time checker (wall clock)
+static inline double timeCheckerWall(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Random numbers for synthetic workloads (the same sequence in every run)
+static uint64_t xorshift_state = 88172645463325252ULL;
+static inline uint64_t xorshift() {
+        xorshift_state ^= xorshift_state << 13;
+        xorshift_state ^= xorshift_state >> 7;
+        xorshift_state ^= xorshift_state << 17;
+        return xorshift_state;
+}
+
+// Keeps results alive so the measured loops are not optimized away
+inline volatile long long sink;
+
+// Random uniform 3-SAT in DIMACS format, after unit clauses of the variables 1..units
+static inline std::string random_cnf( int vars, double ratio, int units = 0 ) {
+        int clauses = (int)(vars * ratio);
+        std::string text = "p cnf " + std::to_string(vars) + " " + std::to_string(clauses + units) + "\n";
+        for ( int v = 1; v <= units; v++ ) text += std::to_string(v) + " 0\n";
+        for ( int i = 0; i < clauses; i++ ) {
+                for ( int k = 0; k < 3; k++ ) {
+                        int v = 1 + xorshift() % vars;
+                        text += std::to_string(xorshift() & 1 ? v : -v) + " ";
+                }
+                text += "0\n";
+        }
+        return text;
+}
+
+// Write text to a new temporary file, returns its name
+static inline std::string write_temp( const std::string &text ) {
+        char name[] = "/tmp/bench_XXXXXX";
+        int fd = mkstemp(name);
+        FILE *f = fdopen(fd, "w");
+        fwrite(text.data(), 1, text.size(), f);
+        fclose(f);
+        return name;
+}
+
+#endif
@@ -0,0 +1,141 @@
+// Heap microbenchmark
+// Compare the binary heap with d-ary heaps on the same operation sequence
+//
+// Usage: ./obj/heap [heap.trace]
+// Without a trace, synthetic VSIDS-like workloads are used.
+// To record a trace from a real run:
+//	make -C .. FLAGS=-DHEAP_TRACE && ../obj/main <cnf file>	(writes heap.trace)
+#include "../solver.h"
+#include "common.h"
+
+
+// Load a recorded trace
+static bool load_trace( const char *filename, std::vector<HeapOp> &ops ) {
+        FILE *f = fopen(filename, "rb");
+        if ( f == NULL ) return false;
+        HeapOp o;
+        while ( fread(&o, sizeof(HeapOp), 1, f) == 1 ) ops.push_back(o);
+        fclose(f);
+        return ops.size() > 0 && ops[0].op == 'n';
+}
+
+// Synthetic workload: decide some variables, bump the analyzed ones, backtrack
+static void synthetic_trace( int vars, int rounds, std::vector<HeapOp> &ops ) {
+        std::vector<uint64_t> activity(vars + 1, 0);
+        HeapOp o = { 'n', vars, 0 };
+        ops.push_back(o);
+        for ( int v = 1; v <= vars; v++ ) {
+                HeapOp i = { 'i', v, 0 };
+                ops.push_back(i);
+        }
+        for ( int r = 0; r < rounds; r++ ) {
+                // Decisions
+                int decisions = 8 + xorshift() % 24;
+                for ( int k = 0; k < decisions; k++ ) {
+                        HeapOp p = { 'p', 0, 0 };
+                        ops.push_back(p);
+                }
+                // Conflict analysis bumps variables clustered around a random variable
+                int center = 1 + xorshift() % vars;
+                int bumps = 20 + xorshift() % 60;
+                for ( int k = 0; k < bumps; k++ ) {
+                        int v = center + (int)(xorshift() % 1024) - 512;
+                        if ( v < 1 || v > vars ) continue;
+                        activity[v] += (k & 1) ? 2 : 4;
+                        HeapOp u = { 'u', v, activity[v] };
+                        ops.push_back(u);
+                }
+                // Backtracking puts unassigned variables back
+                // (replay skips those that are still in the heap)
+                for ( int k = 0; k < decisions; k++ ) {
+                        int v = 1 + xorshift() % vars;
+                        HeapOp i = { 'i', v, activity[v] };
+                        ops.push_back(i);
+                }
+                // The solver decays every conflict, here less often
+                // to keep the O(n) decay from hiding the heap operations
+                if ( r % 64 == 0 ) {
+                        for ( int v = 1; v <= vars; v++ ) if ( activity[v] ) activity[v]--;
+                        HeapOp d = { 'd', 0, 0 };
+                        ops.push_back(d);
+                }
+        }
+}
+
+// Replay a trace on a heap and report ns/op
+// Ties can be broken differently from the recorded run,
+// so inserts of variables already in the heap and updates of missing ones are skipped
+template <class H>
+static void replay( const char *name, const std::vector<HeapOp> &ops, int repeat ) {
+        int vars = ops[0].var;
+        std::vector<uint64_t> activity(vars + 1, 0);
+        uint64_t checksum = 0;
+        long long executed = 0;
+        double best = 1e100;
+
+        for ( int t = 0; t < repeat; t++ ) {
+                H heap;
+                std::fill(activity.begin(), activity.end(), 0);
+                heap.initialize(activity.data(), vars);
+                executed = 0;
+
+                double start = timeCheckerWall();
+                for ( size_t k = 1; k < ops.size(); k++ ) {
+                        const HeapOp &o = ops[k];
+                        if ( o.op == 'i' ) {
+                                if ( heap.inHeap(o.var) ) continue;
+                                activity[o.var] = o.activity;
+                                heap.insert(o.var);
+                        } else if ( o.op == 'u' ) {
+                                if ( o.activity < activity[o.var] ) continue;
+                                activity[o.var] = o.activity;
+                                if ( !heap.inHeap(o.var) ) continue;
+                                heap.update(o.var);
+                        } else if ( o.op == 'p' ) {
+                                if ( heap.empty() ) continue;
+                                checksum += heap.pop();
+                        } else if ( o.op == 'd' ) {
+                                for ( int v = 1; v <= vars; v++ ) if ( activity[v] ) activity[v]--;
+                                heap.decay();
+                        } else if ( o.op == 'r' ) {
+                                heap.refresh();
+                        }
+                        executed++;
+                }
+                double elapsed = timeCheckerWall() - start;
+                if ( elapsed < best ) best = elapsed;
+        }
+        printf( "%-10s %12lld %10.2f %10.2f   (checksum %llu)\n", name, executed,
+                best * 1e9 / executed, executed / best / 1e6, (unsigned long long)checksum );
+}
+
+static void run_all( const std::vector<HeapOp> &ops, int repeat ) {
+        printf( "%-10s %12s %10s %10s\n", "heap", "ops", "ns/op", "Mops/s" );
+        replay<Heap>("binary", ops, repeat);
+        replay< DHeap<2> >("pair-2", ops, repeat);
+        replay< DHeap<4> >("pair-4", ops, repeat);
+        replay< DHeap<8> >("pair-8", ops, repeat);
+}
+
+
+int main( int argc, char **argv ) {
+        std::vector<HeapOp> ops;
+
+        if ( argc > 1 ) {
+                if ( !load_trace(argv[1], ops) ) {
+                        printf( "c Cannot read trace: %s\n", argv[1] );
+                        return 1;
+                }
+                printf( "Trace %s: %d variables, %d operations\n", argv[1], ops[0].var, (int)ops.size() - 1 );
+                run_all(ops, 3);
+        } else {
+                int sizes[3] = { 10000, 100000, 1000000 };
+                for ( int s = 0; s < 3; s++ ) {
+                        ops.clear();
+                        synthetic_trace(sizes[s], 50000, ops);
+                        printf( "Synthetic: %d variables, %d operations\n", sizes[s], (int)ops.size() - 1 );
+                        run_all(ops, 3);
+                }
+        }
+        return 0;
+}
@@ -0,0 +1,92 @@
+// Per-variable layout microbenchmark
+// Compare separate level/reason/mark arrays (default) with one VarData record
+// per variable (-DVAR_AOS) on the access pattern of analyze()
+//
+// Usage: ./obj/layout
+// Every visit reads level and mark of a random variable, sets mark and reads
+// reason, as analyze() does for the literals of the reason clauses.
+// LLC misses per visit are reported when hardware counters are available.
+#include <string>
+#include "../solver.h"
+#include "common.h"
+
+
+
+// Separate arrays
+struct Separate {
+        std::vector<int> level, mark;
+        std::vector<CRef> reason;
+        Separate( int n ): level(n + 1), mark(n + 1), reason(n + 1) {
+                for ( int v = 0; v <= n; v++ ) level[v] = v % 64, reason[v] = v, mark[v] = 0;
+        }
+        int &level_of( int v ) { return level[v]; }
+        CRef &reason_of( int v ) { return reason[v]; }
+        int &mark_of( int v ) { return mark[v]; }
+};
+
+// One record per variable
+struct Records {
+        std::vector<VarData> data;
+        Records( int n ): data(n + 1) {
+                for ( int v = 0; v <= n; v++ ) data[v].level = v % 64, data[v].reason = v, data[v].mark = 0;
+        }
+        int &level_of( int v ) { return data[v].level; }
+        CRef &reason_of( int v ) { return data[v].reason; }
+        int &mark_of( int v ) { return data[v].mark; }
+};
+
+
+// Visit variables in groups of 32 (one "conflict" each)
+template <class Layout>
+static double run( Layout &l, const std::vector<int> &visits, PerfCounters &perf, uint64_t &misses ) {
+        uint64_t before[PERF_EVENTS], after[PERF_EVENTS];
+        long long sum = 0;
+        int stamp = 0, count = 0;
+        perf.read(before);
+        double start = timeCheckerWall();
+        for ( size_t i = 0; i < visits.size(); i++ ) {
+                if ( (i & 31) == 0 ) stamp++;
+                int v = visits[i];
+                if ( l.mark_of(v) != stamp && l.level_of(v) > 0 ) {
+                        l.mark_of(v) = stamp;
+                        if ( l.level_of(v) >= 32 ) count++;
+                        sum += l.reason_of(v);
+                }
+        }
+        double elapsed = timeCheckerWall() - start;
+        perf.read(after);
+        misses = after[PERF_LLC_MISSES] - before[PERF_LLC_MISSES];
+        sink = sum + count;
+        return elapsed;
+}
+
+template <class Layout>
+static void bench( const char *name, int vars, const std::vector<int> &visits, PerfCounters &perf ) {
+        Layout l(vars);
+        double best = 1e100;
+        uint64_t best_misses = 0;
+        for ( int t = 0; t < 3; t++ ) {
+                uint64_t misses;
+                double elapsed = run(l, visits, perf, misses);
+                if ( elapsed < best ) best = elapsed, best_misses = misses;
+        }
+        printf( "%-10s %10d %10.2f", name, vars, best * 1e9 / visits.size() );
+        if ( perf.available ) printf( " %12.3f", (double)best_misses / visits.size() );
+        printf( "\n" );
+}
+
+
+int main() {
+        PerfCounters perf;
+        perf.open();
+        printf( "%-10s %10s %10s%s\n", "layout", "vars", "ns/visit", perf.available ? "  LLC misses/visit" : "" );
+
+        int sizes[4] = { 10000, 100000, 1000000, 10000000 };
+        for ( int s = 0; s < 4; s++ ) {
+                std::vector<int> visits(1 << 23);
+                for ( size_t i = 0; i < visits.size(); i++ ) visits[i] = 1 + xorshift() % sizes[s];
+                bench<Separate>("separate", sizes[s], visits, perf);
+                bench<Records>("records", sizes[s], visits, perf);
+        }
+        return 0;
+}
@@ -0,0 +1,201 @@
+// Microbenchmarks for the hot paths of the solver
+// propagate(), analyze(), VSIDS heap operations, and the CNF parser
+//
+// Usage: ./obj/micro [cnf file]
+// propagate() and analyze() replay a recorded workload:
+// the solver first learns clauses for a while, then the decisions of
+// a number of descents (level 0 until a conflict) are recorded and
+// replayed on the same clause database.
+// Without a CNF file, random 3-SAT instances of several sizes are used.
+#include <string.h>
+#include <string>
+#include "../solver.h"
+#include "common.h"
+
+
+// One line of the report
+static void report( const char *name, const char *size, double ops, double seconds, const char *unit ) {
+        printf( "%-22s %-12s %14.0f %10.2f %12.2f %s\n", name, size, ops,
+                seconds * 1e9 / ops, ops / seconds / 1e6, unit );
+}
+
+// A recorded descent: decisions from level 0 until a conflict (or a model)
+struct Descent {
+        std::vector<int> decisions;
+};
+
+// Record descents without learning clauses
+// analyze() is still called at each conflict to move the heuristics along
+static void record( Solver &S, int count, std::vector<Descent> &descents ) {
+        for ( int n = 0; n < count; n++ ) {
+                S.backtrack(0);
+                Descent d;
+                int cref;
+                while ( (cref = S.propagate()) == -1 ) {
+                        int before = S.trail.size();
+                        if ( S.decide() == 10 ) break;
+                        d.decisions.push_back(S.trail[before]);
+                }
+                descents.push_back(d);
+                if ( cref != -1 ) {
+                        int backtrackLevel = 0, lbd = 0;
+                        if ( S.analyze(cref, backtrackLevel, lbd) == 20 ) break;
+                }
+        }
+        S.backtrack(0);
+}
+
+// Replay the descents
+// Returns the time spent in assigning and propagating the decisions, and in analyze()
+static void replay( Solver &S, const std::vector<Descent> &descents,
+                    double &propagate_time, double &propagated,
+                    double &analyze_time, double &analyzed ) {
+        propagate_time = propagated = analyze_time = analyzed = 0;
+        for ( size_t n = 0; n < descents.size(); n++ ) {
+                const Descent &d = descents[n];
+                S.backtrack(0);
+                int base = S.trail.size();
+                int cref = -1;
+                double start = timeCheckerWall();
+                for ( size_t k = 0; k < d.decisions.size(); k++ ) {
+                        if ( S.value[abs(d.decisions[k])] != 0 ) continue;
+                        S.decVarInTrail.push_back(S.trail.size());
+                        S.assign(d.decisions[k], S.decVarInTrail.size(), -1);
+                        if ( (cref = S.propagate()) != -1 ) break;
+                }
+                propagate_time += timeCheckerWall() - start;
+                propagated += S.trail.size() - base;
+
+                if ( cref != -1 ) {
+                        int backtrackLevel = 0, lbd = 0;
+                        start = timeCheckerWall();
+                        S.analyze(cref, backtrackLevel, lbd);
+                        analyze_time += timeCheckerWall() - start;
+                        analyzed++;
+                }
+        }
+        S.backtrack(0);
+}
+
+static void bench_search( const char *filename, const char *size ) {
+        Solver S;
+        if ( S.parse((char *)filename) == 20 ) {
+                printf( "%-22s %-12s (UNSAT at level 0)\n", "propagate", size );
+                return;
+        }
+        // Learn clauses first
+        S.stats.set_format(STATS_NONE);
+        S.conflict_limit = 5000;
+        if ( S.solve() != 30 ) {
+                printf( "%-22s %-12s (solved during warmup)\n", "propagate", size );
+                return;
+        }
+        S.backtrack(0);
+
+        std::vector<Descent> descents;
+        record(S, 2000, descents);
+
+        double best_propagate = 1e100, best_analyze = 1e100, propagated = 0, analyzed = 0;
+        for ( int t = 0; t < 3; t++ ) {
+                double pt, at;
+                replay(S, descents, pt, propagated, at, analyzed);
+                if ( pt < best_propagate ) best_propagate = pt;
+                if ( at < best_analyze ) best_analyze = at;
+        }
+        report("propagate", size, propagated, best_propagate, "literals");
+        if ( analyzed ) report("analyze", size, analyzed, best_analyze, "conflicts");
+}
+
+
+// Synthetic heap workload on the heap compiled into the solver (VarHeap)
+// Pop some variables, bump some, put the popped ones back
+static void bench_heap( int vars ) {
+        std::vector<uint64_t> activity(vars + 1, 0);
+        std::vector<int> popped;
+        double best = 1e100, ops = 0;
+        for ( int t = 0; t < 3; t++ ) {
+                VarHeap heap;
+                std::fill(activity.begin(), activity.end(), 0);
+                heap.initialize(activity.data(), vars);
+                for ( int v = 1; v <= vars; v++ ) heap.insert(v);
+                ops = 0;
+                double start = timeCheckerWall();
+                for ( int r = 0; r < 100000; r++ ) {
+                        popped.clear();
+                        for ( int k = 0; k < 16; k++ ) popped.push_back(heap.pop());
+                        for ( int k = 0; k < 32; k++ ) {
+                                int v = 1 + xorshift() % vars;
+                                activity[v] += 4;
+                                if ( heap.inHeap(v) ) heap.update(v);
+                        }
+                        for ( size_t k = 0; k < popped.size(); k++ ) heap.insert(popped[k]);
+                        ops += 64;
+                }
+                double elapsed = timeCheckerWall() - start;
+                if ( elapsed < best ) best = elapsed;
+        }
+        report("heap pop/update/insert", std::to_string(vars).c_str(), ops, best, "operations");
+}
+
+
+// read_int() over a DIMACS buffer, and parse() of a whole file
+static void bench_parser( int vars ) {
+        std::string text = random_cnf(vars, 4.2);
+        std::string size = std::to_string(text.size() / 1024) + "KB";
+
+        // Only the clause lines
+        std::string body = text.substr(text.find('\n') + 1);
+        double best = 1e100, ints = 0;
+        long long checksum = 0;
+        for ( int t = 0; t < 3; t++ ) {
+                uint8_t *p = (uint8_t *)body.c_str();
+                uint8_t *end = p + body.size();
+                ints = 0;
+                double start = timeCheckerWall();
+                while ( p < end ) {
+                        int x;
+                        p = read_int(p, &x);
+                        p = read_whitespace(p);
+                        checksum += x;
+                        ints++;
+                }
+                double elapsed = timeCheckerWall() - start;
+                if ( elapsed < best ) best = elapsed;
+        }
+        report("read_int", size.c_str(), ints, best, "integers");
+
+        std::string filename = write_temp(text);
+        best = 1e100;
+        for ( int t = 0; t < 3; t++ ) {
+                Solver S;
+                double start = timeCheckerWall();
+                S.parse((char *)filename.c_str());
+                double elapsed = timeCheckerWall() - start;
+                if ( elapsed < best ) best = elapsed;
+        }
+        report("parse", size.c_str(), text.size(), best, "bytes");
+        remove(filename.c_str());
+        sink = checksum;
+}
+
+
+int main( int argc, char **argv ) {
+        printf( "%-22s %-12s %14s %10s %12s\n", "benchmark", "size", "ops", "ns/op", "Mops/s" );
+
+        if ( argc > 1 ) bench_search(argv[1], "input");
+        else {
+                int sizes[3] = { 1000, 10000, 100000 };
+                for ( int s = 0; s < 3; s++ ) {
+                        std::string filename = write_temp(random_cnf(sizes[s], 4.2));
+                        bench_search(filename.c_str(), std::to_string(sizes[s]).c_str());
+                        remove(filename.c_str());
+                }
+        }
+
+        int heap_sizes[3] = { 10000, 100000, 1000000 };
+        for ( int s = 0; s < 3; s++ ) bench_heap(heap_sizes[s]);
+
+        int parser_sizes[2] = { 10000, 1000000 };
+        for ( int s = 0; s < 2; s++ ) bench_parser(parser_sizes[s]);
+        return 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Prefetch distance sweep
+# Builds the solver with -DPREFETCH=<distance> for every distance and reports
+# the best wall time of a few runs with a conflict limit on the same instance.
+#
+# Usage: ./prefetch.sh <cnf file> [conflicts] [runs] [distances...]
+# e.g.   ./prefetch.sh big.cnf 200000 3 0 2 4 8 16
+# Large instances (watch lists and clauses well beyond the last-level cache)
+# show the difference, small ones fit in the cache and do not.
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <cnf file> [conflicts] [runs] [distances...]"
+	exit 1
+fi
+CNF=$1
+CONFLICTS=${2:-100000}
+RUNS=${3:-3}
+if [ $# -ge 3 ]; then shift 3; else shift $#; fi
+DISTANCES=${*:-0 2 4 8 16}
+
+mkdir -p obj
+printf "%-10s %10s %10s\n" "distance" "seconds" "speedup"
+base=
+for d in $DISTANCES; do
+	g++ -o obj/prefetch_$d ../*.cpp -Wall -pedantic -g -O2 -DPREFETCH=$d || exit 1
+	best=
+	for r in $(seq $RUNS); do
+		start=$(date +%s.%N)
+		obj/prefetch_$d --conflicts=$CONFLICTS --stats=none $CNF > /dev/null
+		t=$(awk -v s=$start -v e=$(date +%s.%N) 'BEGIN { print e - s }')
+		best=$(awk -v b=${best:-1e100} -v t=$t 'BEGIN { print (t < b) ? t : b }')
+	done
+	base=${base:-$best}
+	awk -v d=$d -v t=$best -v b=$base 'BEGIN { printf "%-10s %10.2f %9.3fx\n", d, t, b / t }'
+done
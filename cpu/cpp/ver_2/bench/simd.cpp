@@ -0,0 +1,72 @@
+// Replacement watch search microbenchmark
+// Scalar vs. AVX2 vs. AVX-512 find_non_false() by clause length
+//
+// Usage: ./obj/simd
+// Every search scans lits[2, length) of a random clause whose first non-false literal
+// is at a uniformly random position (or nowhere, as in a unit or conflicting clause).
+// The results of all kernels are checked against the scalar one.
+#include <vector>
+#include "../solver.h"
+#include "common.h"
+
+
+#define VARS 100000
+#define CLAUSES 2048
+
+
+int main() {
+	// Values: every literal false except the chosen position of each clause
+	std::vector<int8_t> value(VARS + 1 + SIMD_PADDING, 0);
+	for ( int v = 1; v <= VARS; v++ ) value[v] = (xorshift() & 1) ? 1 : -1;
+
+	int supported = simd_supported();
+	printf( "%-8s", "length" );
+	for ( int s = 0; s <= supported; s++ ) printf( " %10s", simd_name(s) );
+	printf( "   (ns/search)\n" );
+
+	int lengths[9] = { 4, 8, 16, 32, 64, 128, 256, 512, 1024 };
+	for ( int n = 0; n < 9; n++ ) {
+		int length = lengths[n];
+		std::vector<int> lits((size_t)CLAUSES * length);
+		for ( int c = 0; c < CLAUSES; c++ ) {
+			int stop = 2 + xorshift() % (length - 1);	// length: all false
+			for ( int k = 0; k < length; k++ ) {
+				int v = 1 + xorshift() % VARS;
+				// False: the sign opposite to the value, true at 'stop'
+				int l = value[v] > 0 ? -v : v;
+				lits[(size_t)c * length + k] = k == stop ? -l : l;
+			}
+		}
+		// The chosen literals may share a variable with a false one, so the scalar result is the reference
+		std::vector<int> expected(CLAUSES);
+		simd_select(SIMD_SCALAR);
+		for ( int c = 0; c < CLAUSES; c++ ) expected[c] = find_non_false(&lits[(size_t)c * length], 2, length, value.data());
+
+		printf( "%-8d", length );
+		for ( int s = 0; s <= supported; s++ ) {
+			simd_select(s);
+			for ( int c = 0; c < CLAUSES; c++ ) {
+				if ( find_non_false(&lits[(size_t)c * length], 2, length, value.data()) != expected[c] ) {
+					printf( "\n%s: wrong result for clause %d of length %d\n", simd_name(s), c, length );
+					return 1;
+				}
+			}
+			int rounds = 1 + (1 << 22) / ((size_t)CLAUSES * length);
+			double best = 1e100;
+			for ( int t = 0; t < 3; t++ ) {
+				long long sum = 0;
+				double start = timeCheckerWall();
+				for ( int r = 0; r < rounds; r++ ) {
+					for ( int c = 0; c < CLAUSES; c++ ) sum += find_non_false(&lits[(size_t)c * length], 2, length, value.data());
+				}
+				double elapsed = timeCheckerWall() - start;
+				sink = sum;
+				if ( elapsed < best ) best = elapsed;
+			}
+			printf( " %10.2f", best * 1e9 / ((double)rounds * CLAUSES) );
+		}
+		printf( "\n" );
+	}
+	simd_select(supported);
+	return 0;
+}
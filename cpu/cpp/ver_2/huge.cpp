@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include "huge.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+HugeArena huge_arena;
+
+
+// Size class of a block and its rounded size
+static inline int size_class( size_t bytes, size_t &rounded ) {
+	if ( bytes <= 1024 ) {
+		int c = bytes ? (int)((bytes - 1) >> 4) : 0;
+		rounded = (size_t)(c + 1) << 4;
+		return c;
+	}
+	// 2^b < bytes <= 2^(b+1), in four steps
+	int b = 63 - __builtin_clzll(bytes - 1);
+	size_t step = (size_t)1 << (b - 2);
+	int q = (int)((bytes - 1 - ((size_t)1 << b)) / step);
+	rounded = ((size_t)1 << b) + (q + 1) * step;
+	return 64 + (b - 10) * 4 + q;
+}
+
+static inline size_t round_pages( size_t bytes ) {
+	return (bytes + HUGE_PAGE - 1) & ~(size_t)(HUGE_PAGE - 1);
+}
+
+
+HugeArena::HugeArena(): top(NULL), end(NULL), mode(HUGE_OFF), allocations(0), mapped(0), hugetlb_mapped(0), hugetlb_failures(0) {
+	for ( int i = 0; i < HUGE_CLASSES; i++ ) free_list[i] = NULL;
+}
+
+HugeArena::~HugeArena() {
+	while ( !regions.empty() ) unmap(regions.back(), region_bytes.back());
+}
+
+bool HugeArena::select( int m ) {
+	if ( m == mode ) return true;
+	if ( allocations ) return false;
+#ifndef __linux__
+	if ( m != HUGE_OFF ) return false;
+#endif
+	mode = m;
+	return true;
+}
+
+#ifdef __linux__
+
+// A 2 MB aligned region of 'bytes' (a multiple of HUGE_PAGE)
+void *HugeArena::map( size_t bytes ) {
+	char *region = NULL;
+	if ( mode == HUGE_HUGETLB ) {
+		void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if ( p != MAP_FAILED ) region = (char *)p, hugetlb_mapped += bytes;
+		else hugetlb_failures++;
+	}
+	if ( region == NULL ) {
+		// One huge page more, then trim to the alignment
+		char *p = (char *)mmap(NULL, bytes + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if ( p == MAP_FAILED ) throw std::bad_alloc();
+		region = (char *)(((uintptr_t)p + HUGE_PAGE - 1) & ~(uintptr_t)(HUGE_PAGE - 1));
+		if ( region > p ) munmap(p, region - p);
+		if ( p + HUGE_PAGE > region ) munmap(region + bytes, p + HUGE_PAGE - region);
+		madvise(region, bytes, MADV_HUGEPAGE);
+	}
+	regions.push_back(region);
+	region_bytes.push_back(bytes);
+	mapped += bytes;
+	return region;
+}
+
+void HugeArena::unmap( void *p, size_t bytes ) {
+	for ( size_t i = regions.size(); i-- > 0; ) {
+		if ( regions[i] != p ) continue;
+		regions[i] = regions.back(), regions.pop_back();
+		region_bytes[i] = region_bytes.back(), region_bytes.pop_back();
+		break;
+	}
+	munmap(p, bytes);
+	mapped -= bytes;
+}
+
+#else
+
+// Never called: select() keeps HUGE_OFF on other platforms
+void *HugeArena::map( size_t bytes ) { throw std::bad_alloc(); }
+void HugeArena::unmap( void *p, size_t bytes ) {}
+
+#endif
+
+void *HugeArena::allocate( size_t bytes ) {
+	allocations++;
+	if ( bytes > HUGE_MAX_BLOCK ) return map(round_pages(bytes));
+	size_t rounded;
+	int c = size_class(bytes, rounded);
+	if ( free_list[c] ) {
+		void *p = free_list[c];
+		free_list[c] = *(void **)p;
+		return p;
+	}
+	// The rest of the current region is left unused
+	if ( top == NULL || top + rounded > end ) {
+		top = (char *)map(HUGE_REGION);
+		end = top + HUGE_REGION;
+	}
+	void *p = top;
+	top += rounded;
+	return p;
+}
+
+void HugeArena::release( void *p, size_t bytes ) {
+	if ( p == NULL ) return;
+	if ( bytes > HUGE_MAX_BLOCK ) {
+		unmap(p, round_pages(bytes));
+		return;
+	}
+	size_t rounded;
+	int c = size_class(bytes, rounded);
+	*(void **)p = free_list[c];
+	free_list[c] = p;
+}
+
+
+int64_t huge_anon_bytes() {
+	FILE *f = fopen("/proc/self/smaps_rollup", "r");
+	if ( f == NULL ) return -1;
+	char line[256];
+	int64_t kb = -1;
+	while ( fgets(line, sizeof(line), f) ) {
+		long long n;
+		if ( sscanf(line, "AnonHugePages: %lld kB", &n) == 1 ) kb = n;
+	}
+	fclose(f);
+	return kb < 0 ? -1 : kb * 1024;
+}
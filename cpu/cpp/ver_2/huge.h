@@ -0,0 +1,90 @@
+#ifndef HUGE_H
+#define HUGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <vector>
+
+// Huge page backed storage for clauses and watcher lists
+// With HUGE_THP or HUGE_HUGETLB, blocks come from 2 MB aligned regions of HUGE_REGION bytes:
+//  - HUGE_THP: madvise(MADV_HUGEPAGE), so the kernel backs them with transparent huge pages
+//  - HUGE_HUGETLB: mmap(MAP_HUGETLB) from the reserved huge pages (vm.nr_hugepages),
+//    falling back to HUGE_THP when none are left
+// Blocks up to HUGE_MAX_BLOCK bytes are rounded up to a size class (16-byte steps up to 1 KB,
+// then four classes per power of two) and recycled through a free list per class;
+// larger blocks get regions of their own. With HUGE_OFF (default), operator new is used.
+// The mode is chosen before the first allocation (--huge=off|thp|hugetlb).
+
+#define HUGE_OFF 0
+#define HUGE_THP 1
+#define HUGE_HUGETLB 2
+
+#define HUGE_PAGE (2 << 20)
+#define HUGE_REGION (32 << 20)
+#define HUGE_MAX_BLOCK (1 << 20)
+#define HUGE_CLASSES 104
+
+
+class HugeArena {
+	void *free_list[HUGE_CLASSES];	// Released blocks per size class
+	char *top, *end;		// Unused part of the current region
+	std::vector<void *> regions;	// Mapped regions and their bytes (unmapped by the destructor)
+	std::vector<size_t> region_bytes;
+
+	void *map( size_t bytes );
+	void unmap( void *p, size_t bytes );
+public:
+	int mode;			// HUGE_OFF, HUGE_THP or HUGE_HUGETLB
+	int64_t allocations;		// Blocks handed out in any mode (the mode is fixed after the first one)
+	size_t mapped;			// Bytes of all mapped regions
+	size_t hugetlb_mapped;		// ... of them from MAP_HUGETLB
+	int hugetlb_failures;		// MAP_HUGETLB regions that fell back to transparent huge pages
+
+	HugeArena();
+	~HugeArena();
+
+	// Change the mode, false if blocks were already allocated
+	bool select( int m );
+	void *allocate( size_t bytes );
+	void release( void *p, size_t bytes );
+
+	static const char *name( int m ) {
+		const char *names[3] = { "off", "thp", "hugetlb" };
+		return names[m];
+	}
+};
+
+extern HugeArena huge_arena;
+
+// Bytes of anonymous memory backed by transparent huge pages (/proc/self/smaps_rollup, -1 if unknown)
+int64_t huge_anon_bytes();
+
+
+// STL allocator on huge_arena
+template <class T>
+struct HugeAllocator {
+	typedef T value_type;
+
+	HugeAllocator() {}
+	template <class U> HugeAllocator( const HugeAllocator<U> & ) {}
+
+	T *allocate( size_t n ) {
+		if ( huge_arena.mode == HUGE_OFF ) {
+			huge_arena.allocations++;
+			return (T *)::operator new(n * sizeof(T));
+		}
+		return (T *)huge_arena.allocate(n * sizeof(T));
+	}
+	void deallocate( T *p, size_t n ) {
+		if ( huge_arena.mode == HUGE_OFF ) ::operator delete(p);
+		else huge_arena.release(p, n * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator==( const HugeAllocator<T> &, const HugeAllocator<U> & ) { return true; }
+template <class T, class U>
+bool operator!=( const HugeAllocator<T> &, const HugeAllocator<U> & ) { return false; }
+
+#endif
@@ -1,17 +1,140 @@
+#include <string.h>
+#include <signal.h>
 #include "solver.h"
 
 
+// Restart policy by name (-1 if unknown)
+static int restart_by_name( const char *name ) {
+        const char *names[5] = { "queue", "ema", "luby", "geometric", "reluctant" };
+        for ( int i = 0; i < 5; i++ ) if ( !strcmp(name, names[i]) ) return i;
+        return -1;
+}
+
+// Stop the search and still print the statistics
+static void interrupt( int signal ) {
+        solver_interrupted = 1;
+}
+
+static void usage( const char *name ) {
+        printf("c Usage: %s [options] <cnf file>\n", name);
+        printf("c   --decide=vsids|vmtf\n");
+        printf("c   --mode=focused|stable|switch\n");
+        printf("c   --restart=<policy>, --stable-restart=<policy> (queue|ema|luby|geometric|reluctant)\n");
+        printf("c   --block-restarts\n");
+        printf("c   --conflicts=<n>\n");
+        printf("c   --stats=text|json|csv|none\n");
+        printf("c   --progress=<seconds>\n");
+        printf("c   --perf\n");
+        printf("c   --simd=scalar|avx2|avx512\n");
+        printf("c   --huge=off|thp|hugetlb\n");
+        printf("c   --compress\n");
+        printf("c   --renumber\n");
+        printf("c   --relocate\n");
+        printf("c   --model, --proof=<file>\n");
+        printf("c   --trace=<file>, --trace-interval=<conflicts>, --trace-format=csv|binary\n");
+}
+
 int main( int argc, char **argv ) {
         Solver S;
+        char *filename = NULL;
+        char *trace_file = NULL;
+        int trace_format = TRACE_CSV;
+        int64_t trace_interval = 1000;
+        bool print_model = false;
+        char *proof_file = NULL;
+
+        // Options
+        // --decide=vsids|vmtf : Decision heuristic
+        // --mode=focused|stable|switch : Search mode (switch alternates focused VMTF and stable VSIDS)
+        // --restart=<policy> : Restart policy in focused mode (default: queue)
+        // --stable-restart=<policy> : Restart policy in stable mode (default: reluctant)
+        //      <policy> = queue|ema|luby|geometric|reluctant
+        // --block-restarts : Postpone restarts while the trail is large
+        // --conflicts=<n> : Stop after n conflicts (UNSOLVED)
+        // --stats=text|json|csv|none : Format of the statistics (default: text)
+        // --progress=<seconds> : Print a progress line every <seconds> of CPU time
+        // --model : Print the model of SAT answers
+        // --proof=<file> : Write a DRAT proof of UNSAT answers
+        // --simd=scalar|avx2|avx512 : Kernel of the replacement watch search in long clauses (default: the best the CPU supports)
+        // --huge=off|thp|hugetlb : Clauses and watcher lists in huge page regions (default: off)
+        // --compress : Compress original clauses of 8 or more literals (varints, decoded in propagate() and analyze())
+        // --renumber : Renumber the variables by locality after parsing (model and proof stay in the DIMACS numbering)
+        // --relocate : Relocate the clauses in watch order at every reduce (learnt clauses with their literals)
+        // --perf : Count cycles, instructions, LLC misses and branch misses (Linux perf_event_open)
+        // --trace=<file> : Write a time series of the search (a sample every 1000 conflicts, restarts, rephases, reduces, mode switches)
+        // --trace-interval=<conflicts> : Conflicts between trace samples
+        // --trace-format=csv|binary : Format of the trace (default: csv)
+        for ( int i = 1; i < argc; i++ ) {
+                if ( !strcmp(argv[i], "--decide=vsids") ) S.heuristic = DECIDE_VSIDS;
+                else if ( !strcmp(argv[i], "--decide=vmtf") ) S.heuristic = DECIDE_VMTF;
+                else if ( !strcmp(argv[i], "--mode=focused") ) S.mode = MODE_FOCUSED, S.mode_switching = 0;
+                else if ( !strcmp(argv[i], "--mode=stable") ) S.mode = MODE_STABLE, S.mode_switching = 0;
+                else if ( !strcmp(argv[i], "--mode=switch") ) S.mode_switching = 1;
+                else if ( !strncmp(argv[i], "--restart=", 10) && restart_by_name(argv[i] + 10) >= 0 ) {
+                        S.restart_kind[MODE_FOCUSED] = restart_by_name(argv[i] + 10);
+                }
+                else if ( !strncmp(argv[i], "--stable-restart=", 17) && restart_by_name(argv[i] + 17) >= 0 ) {
+                        S.restart_kind[MODE_STABLE] = restart_by_name(argv[i] + 17);
+                }
+                else if ( !strcmp(argv[i], "--block-restarts") ) S.block_restarts = true;
+                else if ( !strncmp(argv[i], "--conflicts=", 12) ) S.conflict_limit = atoll(argv[i] + 12);
+                else if ( !strcmp(argv[i], "--stats=text") ) S.stats.set_format(STATS_TEXT);
+                else if ( !strcmp(argv[i], "--stats=json") ) S.stats.set_format(STATS_JSON);
+                else if ( !strcmp(argv[i], "--stats=csv") ) S.stats.set_format(STATS_CSV);
+                else if ( !strcmp(argv[i], "--stats=none") ) S.stats.set_format(STATS_NONE);
+                else if ( !strncmp(argv[i], "--progress=", 11) ) S.progress_interval = atof(argv[i] + 11);
+                else if ( !strcmp(argv[i], "--model") ) print_model = true;
+                else if ( !strncmp(argv[i], "--proof=", 8) ) proof_file = argv[i] + 8;
+                else if ( !strcmp(argv[i], "--perf") ) S.perf_enabled = true;
+                else if ( !strcmp(argv[i], "--simd=scalar") ) simd_select(SIMD_SCALAR);
+                else if ( !strcmp(argv[i], "--simd=avx2") ) simd_select(SIMD_AVX2);
+                else if ( !strcmp(argv[i], "--simd=avx512") ) simd_select(SIMD_AVX512);
+                else if ( !strcmp(argv[i], "--compress") ) S.compress = true;
+                else if ( !strcmp(argv[i], "--renumber") ) S.renumber = true;
+                else if ( !strcmp(argv[i], "--relocate") ) S.relocate = true;
+                else if ( !strcmp(argv[i], "--huge=off") ) huge_arena.select(HUGE_OFF);
+                else if ( !strcmp(argv[i], "--huge=thp") || !strcmp(argv[i], "--huge=hugetlb") ) {
+                        if ( !huge_arena.select(argv[i][7] == 't' ? HUGE_THP : HUGE_HUGETLB) ) {
+                                printf("c Huge pages are not supported on this platform\n");
+                                return 1;
+                        }
+                }
+                else if ( !strncmp(argv[i], "--trace=", 8) ) trace_file = argv[i] + 8;
+                else if ( !strncmp(argv[i], "--trace-interval=", 17) ) trace_interval = atoll(argv[i] + 17);
+                else if ( !strcmp(argv[i], "--trace-format=csv") ) trace_format = TRACE_CSV;
+                else if ( !strcmp(argv[i], "--trace-format=binary") ) trace_format = TRACE_BINARY;
+                else if ( argv[i][0] == '-' ) {
+                        printf("c Unknown option: %s\n", argv[i]);
+                        return 1;
+                }
+                else filename = argv[i];
+        }
+        if ( filename == NULL ) {
+                usage(argv[0]);
+                return 1;
+        }
+        if ( trace_file != NULL && !S.trace.open(trace_file, trace_format, trace_interval) ) {
+                printf("c Cannot open the trace file: %s\n", trace_file);
+                return 1;
+        }
+        if ( proof_file != NULL && !S.open_proof(proof_file) ) {
+                printf("c Cannot open the proof file: %s\n", proof_file);
+                return 1;
+        }
+        signal(SIGINT, interrupt);
+        signal(SIGTERM, interrupt);
         
-        int res = S.parse(argv[1]);
+        int res = S.parse(filename);
         
-        if ( res == 20 ) printf("UNSATISFIABLE\n");
+        if ( res == 20 ) {
+                S.report(res);
+                printf("UNSATISFIABLE\n");
+        }
         else {
                 res = S.solve();
                 if ( res == 10 ) {
 			printf("SATISFIABLE\n");
-                        //S.printModel();
+                        if ( print_model ) S.printModel();
                 }
                 else if ( res == 20 ) printf("UNSATISFIABLE\n");
 		else if ( res == 30 ) printf( "UNSOLVED\n" );
@@ -0,0 +1,66 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+#include <vector>
+
+// Memory accounting per solver data structure
+// Sizes are computed from the allocations (vector capacities, array lengths),
+// so allocator overhead and freed-but-cached memory are not included.
+// Full updates (Solver::account_memory()) walk the structures; in between, the places where a
+// structure grows add to it, so peaks between two full updates are seen too.
+
+// Structures
+#define MEM_VARIABLES 0		// Per-variable arrays (value, phases, reason, level, mark, activity)
+#define MEM_CLAUSES 1		// Clause database (clause headers and literals)
+#define MEM_WATCHERS 2		// Watcher lists
+#define MEM_TRAIL 3		// Trail, decision positions, learnt clause and reduce map
+#define MEM_HEAP 4		// VSIDS heap
+#define MEM_QUEUE 5		// VMTF queue
+#define MEM_PARSER 6		// Input file buffer (only while parsing)
+#define MEM_STRUCTURES 7
+
+
+// Bytes allocated by a vector
+template <class T, class A>
+static inline size_t vector_bytes( const std::vector<T, A> &v ) { return v.capacity() * sizeof(T); }
+
+
+class MemoryAccount {
+public:
+	size_t live[MEM_STRUCTURES];	// Bytes at the last update
+	size_t peak[MEM_STRUCTURES];	// Largest bytes seen by an update
+
+	MemoryAccount() {
+		for ( int i = 0; i < MEM_STRUCTURES; i++ ) live[i] = peak[i] = 0;
+	}
+
+	void set( int structure, size_t bytes ) {
+		live[structure] = bytes;
+		if ( bytes > peak[structure] ) peak[structure] = bytes;
+	}
+
+	// Growth (or shrinkage) since the last update
+	void add( int structure, ptrdiff_t bytes ) {
+		set(structure, live[structure] + bytes);
+	}
+
+	// A peak reached inside a structure since the last update
+	void peak_at( int structure, size_t bytes ) {
+		if ( bytes > peak[structure] ) peak[structure] = bytes;
+	}
+
+	size_t total() const {
+		size_t sum = 0;
+		for ( int i = 0; i < MEM_STRUCTURES; i++ ) sum += live[i];
+		return sum;
+	}
+
+	static const char *name( int structure ) {
+		const char *names[MEM_STRUCTURES] = { "variables", "clauses", "watchers", "trail",
+						      "heap", "queue", "parser" };
+		return names[structure];
+	}
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include <string.h>
+#include <errno.h>
+#include "perf.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+PerfCounters::PerfCounters(): rdpmc(false), available(false), error(0) {
+	for ( int i = 0; i < PERF_EVENTS; i++ ) fd[i] = -1, page[i] = NULL;
+}
+
+#ifdef __linux__
+
+bool PerfCounters::open() {
+	const uint32_t types[PERF_EVENTS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+					      PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+	const uint64_t configs[PERF_EVENTS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+						PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+						PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+						(PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+	close();
+	for ( int i = 0; i < PERF_EVENTS; i++ ) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = types[i];
+		attr.config = configs[i];
+		attr.disabled = i == 0;		// The whole group starts with the leader
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd[0], 0);
+		if ( fd[i] < 0 ) {
+			error = errno;
+			close();
+			return false;
+		}
+	}
+
+	// rdpmc needs the metadata page of every counter
+	rdpmc = true;
+	for ( int i = 0; i < PERF_EVENTS; i++ ) {
+		void *p = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd[i], 0);
+		if ( p == MAP_FAILED ) rdpmc = false;
+		else {
+			page[i] = p;
+			if ( !((struct perf_event_mmap_page *)p)->cap_user_rdpmc ) rdpmc = false;
+		}
+	}
+#if !defined(__x86_64__) && !defined(__i386__)
+	rdpmc = false;
+#endif
+
+	ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	available = true;
+	return true;
+}
+
+void PerfCounters::close() {
+	for ( int i = PERF_EVENTS - 1; i >= 0; i-- ) {
+		if ( page[i] ) munmap(page[i], sysconf(_SC_PAGESIZE));
+		if ( fd[i] >= 0 ) ::close(fd[i]);
+		fd[i] = -1, page[i] = NULL;
+	}
+	available = rdpmc = false;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Read a counter in user space [Based on the perf_event_mmap_page documentation]
+static inline bool read_rdpmc( volatile struct perf_event_mmap_page *pc, uint64_t &count ) {
+	uint32_t seq, index;
+	do {
+		seq = pc->lock;
+		__sync_synchronize();
+		index = pc->index;
+		int64_t c = pc->offset;
+		if ( index == 0 ) return false;		// Not scheduled on a counter right now
+		uint32_t lo, hi;
+		__asm__ volatile( "rdpmc" : "=a"(lo), "=d"(hi) : "c"(index - 1) );
+		int64_t pmc = (int64_t)(((uint64_t)hi << 32) | lo);
+		int shift = 64 - pc->pmc_width;
+		pmc = (pmc << shift) >> shift;
+		count = c + pmc;
+		__sync_synchronize();
+	} while ( pc->lock != seq );
+	return true;
+}
+#endif
+
+bool PerfCounters::read_user( uint64_t counts[PERF_EVENTS] ) {
+#if defined(__x86_64__) || defined(__i386__)
+	if ( !rdpmc ) return false;
+	for ( int i = 0; i < PERF_EVENTS; i++ ) {
+		if ( !read_rdpmc((volatile struct perf_event_mmap_page *)page[i], counts[i]) ) return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void PerfCounters::read( uint64_t counts[PERF_EVENTS] ) {
+	if ( !available ) {
+		for ( int i = 0; i < PERF_EVENTS; i++ ) counts[i] = 0;
+		return;
+	}
+#if defined(__x86_64__) || defined(__i386__)
+	if ( rdpmc ) {
+		bool ok = true;
+		for ( int i = 0; i < PERF_EVENTS && ok; i++ ) {
+			ok = read_rdpmc((volatile struct perf_event_mmap_page *)page[i], counts[i]);
+		}
+		if ( ok ) return;
+	}
+#endif
+	// nr, then one value per counter
+	uint64_t buffer[1 + PERF_EVENTS];
+	if ( ::read(fd[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer) ) {
+		for ( int i = 0; i < PERF_EVENTS; i++ ) counts[i] = 0;
+		return;
+	}
+	for ( int i = 0; i < PERF_EVENTS; i++ ) counts[i] = buffer[1 + i];
+}
+
+#else
+
+// Not supported on this platform
+bool PerfCounters::open() { error = ENOSYS; return false; }
+void PerfCounters::close() { available = rdpmc = false; }
+void PerfCounters::read( uint64_t counts[PERF_EVENTS] ) {
+	for ( int i = 0; i < PERF_EVENTS; i++ ) counts[i] = 0;
+}
+bool PerfCounters::read_user( uint64_t counts[PERF_EVENTS] ) { return false; }
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+
+// Hardware performance counters (Linux perf_event_open)
+// Counts user-space events of this thread only.
+// Counters are read with rdpmc when the kernel allows it, otherwise with a read() system call.
+
+// Events
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_LLC_MISSES 2	// Last level cache misses (PERF_COUNT_HW_CACHE_MISSES)
+#define PERF_BRANCH_MISSES 3
+#define PERF_DTLB_MISSES 4	// Data TLB load misses (PERF_TYPE_HW_CACHE)
+#define PERF_EVENTS 5
+
+
+class PerfCounters {
+	int fd[PERF_EVENTS];		// fd[0] is the group leader
+	void *page[PERF_EVENTS];	// Mapped metadata pages for rdpmc (NULL if not mapped)
+	bool rdpmc;			// All counters can be read with rdpmc
+public:
+	bool available;			// All counters were opened
+	int error;			// errno of the failed perf_event_open
+
+	PerfCounters();
+	~PerfCounters() { close(); }
+
+	// Open and start the counters, returns false if the hardware or the kernel does not allow it
+	bool open();
+	void close();
+	// Current counts (zeros if not available)
+	void read( uint64_t counts[PERF_EVENTS] );
+	// Current counts with rdpmc only, no system call (false if rdpmc is not allowed or a counter
+	// is not scheduled right now)
+	bool read_user( uint64_t counts[PERF_EVENTS] );
+	bool user_readable() const { return rdpmc; }
+
+	static const char *name( int event ) {
+		const char *names[PERF_EVENTS] = { "cycles", "instructions", "llc_misses", "branch_misses", "dtlb_misses" };
+		return names[event];
+	}
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <stdint.h>
+
+// Static tracepoints (USDT) at solver events, provider "sat"
+// Each probe is a single nop plus an ELF note (.note.stapsdt) that tools such as
+// bpftrace, perf and SystemTap use to place a breakpoint when attached.
+// Arguments are 64-bit signed integers. Build with -DNO_PROBES to remove them.
+//
+//   bpftrace -e 'usdt:./obj/main:sat:learnt { @lbd = hist(arg1); }'
+//
+// Probes:
+//   sat:conflict(conflicts, level, trail size)
+//   sat:learnt(size, lbd, backtrack level)
+//   sat:decide(literal in the DIMACS numbering, level)
+//   sat:restart(restarts, level)
+//   sat:rephase(rephases, conflicts)
+//   sat:reduce(reductions, learnt clauses kept)
+//   sat:mode(mode, conflicts)
+
+#if defined(NO_PROBES)
+
+#define SAT_PROBE2(name, a, b)
+#define SAT_PROBE3(name, a, b, c)
+
+#elif defined(__has_include) && __has_include(<sys/sdt.h>)
+
+#include <sys/sdt.h>
+#define SAT_PROBE2(name, a, b) STAP_PROBE2(sat, name, a, b)
+#define SAT_PROBE3(name, a, b, c) STAP_PROBE3(sat, name, a, b, c)
+
+#elif defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+
+// Same note layout as <sys/sdt.h> (version 3) for systems without the SystemTap headers
+#define SAT_PROBE_NOTE(name, args, ...)							\
+	__asm__ __volatile__ (								\
+		"990: nop\n"								\
+		".pushsection .note.stapsdt,\"?\",\"note\"\n"				\
+		".balign 4\n"								\
+		".4byte 992f-991f, 994f-993f, 3\n"					\
+		"991: .asciz \"stapsdt\"\n"						\
+		"992: .balign 4\n"							\
+		"993: .8byte 990b\n"							\
+		".8byte _.stapsdt.base\n"						\
+		".8byte 0\n"								\
+		".asciz \"sat\"\n"							\
+		".asciz \"" #name "\"\n"						\
+		".asciz \"" args "\"\n"							\
+		"994: .balign 4\n"							\
+		".popsection\n"								\
+		".ifndef _.stapsdt.base\n"						\
+		".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"	\
+		".weak _.stapsdt.base\n"						\
+		".hidden _.stapsdt.base\n"						\
+		"_.stapsdt.base: .space 1\n"						\
+		".size _.stapsdt.base, 1\n"						\
+		".popsection\n"								\
+		".endif\n"								\
+		:: __VA_ARGS__ )
+
+#define SAT_PROBE2(name, a, b)								\
+	SAT_PROBE_NOTE(name, "-8@%0 -8@%1", "nor"((int64_t)(a)), "nor"((int64_t)(b)))
+#define SAT_PROBE3(name, a, b, c)							\
+	SAT_PROBE_NOTE(name, "-8@%0 -8@%1 -8@%2", "nor"((int64_t)(a)), "nor"((int64_t)(b)), "nor"((int64_t)(c)))
+
+#else
+
+#define SAT_PROBE2(name, a, b)
+#define SAT_PROBE3(name, a, b, c)
+
+#endif
+
+#endif
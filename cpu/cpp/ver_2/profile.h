@@ -0,0 +1,160 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "stats.h"
+#include "perf.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Per-phase profiler for the solve loop
+// Build with -DPROFILE for the time per phase.
+// With --perf, hardware events are counted per phase at the same points in every build,
+// read with rdpmc only (no system call); without rdpmc only the totals over solve() are reported.
+// Otherwise the macros cost a test of Profiler::perf.
+
+// Phases
+#define PHASE_PARSE 0
+#define PHASE_PROPAGATE 1
+#define PHASE_ANALYZE 2
+#define PHASE_LEARN 3		// Adding the learnt clause, var_decay and phase updates
+#define PHASE_BACKTRACK 4
+#define PHASE_RESTART 5
+#define PHASE_REPHASE 6
+#define PHASE_REDUCE 7
+#define PHASE_DECIDE 8
+#define PHASE_MODE 9		// Switching between focused and stable mode
+#define PHASES 10
+
+
+// Cycle counter (time stamp counter on x86, monotonic clock in ns otherwise)
+static inline uint64_t profile_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline double profile_wall() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+// Start of a measured interval
+struct ProfileMark {
+	uint64_t ticks;
+	uint64_t counts[PERF_EVENTS];
+	bool counted;			// counts were read
+};
+
+
+class Profiler {
+public:
+	uint64_t ticks[PHASES];		// Cycles spent per phase
+	uint64_t calls[PHASES];		// The number of measured calls per phase
+	uint64_t start_ticks;		// Counter and wall clock at construction
+	double start_wall;		// (calibrate cycles to seconds)
+	PerfCounters *perf;		// Counters for the events per phase (NULL: not counted)
+	uint64_t events[PHASES][PERF_EVENTS];	// Hardware events per phase
+	uint64_t counted[PHASES];	// The number of calls with events per phase
+
+	Profiler(): perf(NULL) {
+		for ( int i = 0; i < PHASES; i++ ) ticks[i] = calls[i] = counted[i] = 0;
+		for ( int i = 0; i < PHASES; i++ ) for ( int e = 0; e < PERF_EVENTS; e++ ) events[i][e] = 0;
+		start_ticks = profile_clock();
+		start_wall = profile_wall();
+	}
+
+	void mark( ProfileMark &m ) {
+		m.counted = perf && perf->read_user(m.counts);
+#ifdef PROFILE
+		m.ticks = profile_clock();
+#endif
+	}
+
+	void add( const ProfileMark &m, int phase, int count ) {
+#ifdef PROFILE
+		ticks[phase] += profile_clock() - m.ticks;
+		calls[phase] += count;
+#endif
+		// A call is skipped if rdpmc failed at either end (a counter was not scheduled)
+		uint64_t counts[PERF_EVENTS];
+		if ( m.counted && perf->read_user(counts) ) {
+			for ( int e = 0; e < PERF_EVENTS; e++ ) events[phase][e] += counts[e] - m.counts[e];
+			counted[phase] += count;
+		}
+	}
+
+	// Add the time per phase to the statistics (e.g. profile_propagate_time, "Profile propagate (s)")
+	void report( std::vector<Stat> &s ) {
+		const char *names[PHASES] = { "parse", "propagate", "analyze", "learn", "backtrack",
+					      "restart", "rephase", "reduce", "decide", "mode" };
+#ifdef PROFILE
+		uint64_t total_ticks = profile_clock() - start_ticks;
+		double total = profile_wall() - start_wall;
+		double rate = total > 0 ? total_ticks / total : 1;
+		uint64_t measured = 0;
+		s.push_back(Stat("profile_time", "Profile (s)", total));
+		s.push_back(Stat("profile_ghz", "Profile clock (GHz)", rate / 1e9));
+		for ( int i = 0; i < PHASES; i++ ) {
+			measured += ticks[i];
+			s.push_back(Stat(text("profile_%s_time", names[i]), text("Profile %s (s)", names[i]), ticks[i] / rate));
+			s.push_back(Stat(text("profile_%s_share", names[i]), text("Profile %s (%%)", names[i]), 100.0 * ticks[i] / total_ticks));
+			s.push_back(Stat(text("profile_%s_calls", names[i]), text("Profile %s calls", names[i]), (int64_t)calls[i]));
+			s.push_back(Stat(text("profile_%s_ns_per_call", names[i]), text("Profile %s (ns/call)", names[i]),
+					 calls[i] ? 1e9 * ticks[i] / rate / calls[i] : 0.0));
+		}
+		s.push_back(Stat("profile_other_time", "Profile other (s)", (total_ticks - measured) / rate));
+		s.push_back(Stat("profile_other_share", "Profile other (%)", 100.0 * (total_ticks - measured) / total_ticks));
+#endif
+		// Events per phase (--perf); they include the rdpmc reads at both ends of every call
+		if ( !perf ) return;
+		for ( int i = 0; i < PHASES; i++ ) {
+			const uint64_t *e = events[i];
+			double n = counted[i] ? counted[i] : 1;
+			s.push_back(Stat(text("perf_%s_calls", names[i]), text("Perf %s calls", names[i]), (int64_t)counted[i]));
+			s.push_back(Stat(text("perf_%s_cycles", names[i]), text("Perf %s cycles", names[i]), (int64_t)e[PERF_CYCLES]));
+			s.push_back(Stat(text("perf_%s_ipc", names[i]), text("Perf %s IPC", names[i]),
+					 e[PERF_CYCLES] ? (double)e[PERF_INSTRUCTIONS] / e[PERF_CYCLES] : 0.0));
+			s.push_back(Stat(text("perf_%s_llc_misses_per_call", names[i]), text("Perf %s LLC misses per call", names[i]), e[PERF_LLC_MISSES] / n));
+			s.push_back(Stat(text("perf_%s_branch_misses_per_call", names[i]), text("Perf %s branch misses per call", names[i]), e[PERF_BRANCH_MISSES] / n));
+			s.push_back(Stat(text("perf_%s_dtlb_misses_per_call", names[i]), text("Perf %s dTLB misses per call", names[i]), e[PERF_DTLB_MISSES] / n));
+		}
+	}
+
+private:
+	// Keys and labels built for report() (Stat keeps the pointers)
+	std::deque<std::string> strings;
+	const char *text( const char *format, const char *phase ) {
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), format, phase);
+		strings.push_back(buffer);
+		return strings.back().c_str();
+	}
+};
+
+
+#ifdef PROFILE
+#define PROFILE_ON true
+#else
+#define PROFILE_ON (profiler.perf != NULL)
+#endif
+#define PROFILE_START(name) ProfileMark profile_##name; if ( PROFILE_ON ) profiler.mark(profile_##name)
+#define PROFILE_STOP(name, phase) do { if ( PROFILE_ON ) profiler.add(profile_##name, phase, 1); } while (0)
+// Stop without counting a call (a phase measured in several parts)
+#define PROFILE_PAUSE(name, phase) do { if ( PROFILE_ON ) profiler.add(profile_##name, phase, 0); } while (0)
+#define PROFILE_REPORT(stats) profiler.report(stats)
+
+#endif
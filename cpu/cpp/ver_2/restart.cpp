@@ -0,0 +1,95 @@
+#include "restart.h"
+
+
+// Create a restart policy
+Restart *make_restart( int kind, bool blocking ) {
+	if ( kind == RESTART_QUEUE ) return new QueueRestart(blocking);
+	else if ( kind == RESTART_EMA ) return new EmaRestart(blocking);
+	else return new ScheduledRestart(kind);
+}
+
+// Luby sequence (1, 1, 2, 1, 1, 2, 4, ...) [Based on MiniSAT]
+uint64_t luby( uint64_t i ) {
+	// Find the finite subsequence that contains index 'i'
+	uint64_t size, seq;
+	for ( size = 1, seq = 0; size < i + 1; seq++, size = 2 * size + 1 );
+	while ( size - 1 != i ) {
+		size = (size - 1) >> 1;
+		seq--;
+		i = i % size;
+	}
+	return (uint64_t)1 << seq;
+}
+
+
+// Recent 50 LBDs against the global average
+void QueueRestart::reset( uint64_t conflicts ) {
+	fast_sum = queue_size = queue_pos = 0;
+}
+
+void QueueRestart::conflict( int lbd, int trail_size, uint64_t conflicts ) {
+	if ( queue_size < 50 ) queue_size++;
+	else fast_sum -= queue[queue_pos];
+
+	// Sum of the recent 50 LBDs
+	fast_sum += lbd;
+	queue[queue_pos++] = lbd;
+	if ( queue_pos == 50 ) queue_pos = 0;
+
+	// Sum of the global LBDs
+	slow_sum += (lbd > 50 ? 50 : lbd);
+	slow_count++;
+
+	// Empty the recent queue to postpone the restart
+	if ( block.blocking(trail_size, conflicts) && queue_size == 50 ) {
+		reset(conflicts);
+		blocked++;
+	}
+}
+
+bool QueueRestart::restarting( uint64_t conflicts ) {
+	// We proposed a new simple heuristic for restarting scheme
+	// Recent average > global average, compared without division
+	return queue_size == 50 && fast_sum * slow_count > slow_sum * queue_size;
+}
+
+
+// Fast and slow exponential moving averages of LBDs
+void EmaRestart::conflict( int lbd, int trail_size, uint64_t conflicts ) {
+	fast.update(lbd);
+	slow.update(lbd);
+
+	// Postpone the restart
+	if ( block.blocking(trail_size, conflicts) && limit < conflicts + 50 ) {
+		limit = conflicts + 50;
+		blocked++;
+	}
+}
+
+bool EmaRestart::restarting( uint64_t conflicts ) {
+	// Restart if the recent LBDs are 10% worse than the long term average
+	return conflicts >= limit && fast.value > 1.1 * slow.value;
+}
+
+
+// Restart after a scheduled number of conflicts
+void ScheduledRestart::reset( uint64_t conflicts ) {
+	luby_index = 0;
+	u = v = 1;
+	interval = 0;
+	schedule(conflicts);
+}
+
+void ScheduledRestart::schedule( uint64_t conflicts ) {
+	if ( kind == RESTART_LUBY ) interval = 100 * luby(luby_index++);
+	else if ( kind == RESTART_GEOMETRIC ) interval = interval ? interval * 3 / 2 : 100;
+	else {
+		// Reluctant doubling generates the Luby sequence [Based on Knuth]
+		interval = 1024 * v;
+		if ( (u & -u) == v ) u++, v = 1;
+		else v *= 2;
+		// Start over beyond 1024 * 1024 conflicts
+		if ( v > 1024 ) u = v = 1;
+	}
+	limit = conflicts + interval;
+}
@@ -0,0 +1,119 @@
+#ifndef RESTART_H
+#define RESTART_H
+
+#include <stdint.h>
+
+// Restart policies
+#define RESTART_QUEUE 0		// Recent 50 LBDs against the global average [Based on Glucose]
+#define RESTART_EMA 1		// Fast and slow exponential moving averages of LBDs [Based on CaDiCaL]
+#define RESTART_LUBY 2		// Luby sequence times 100 conflicts [Based on MiniSAT]
+#define RESTART_GEOMETRIC 3	// 100 conflicts growing by 1.5 times
+#define RESTART_RELUCTANT 4	// Reluctant doubling (Luby sequence times 1024 conflicts) [Based on CaDiCaL]
+
+
+// Exponential moving average
+// The first values are averaged evenly until 1/count reaches alpha (bias correction)
+class Ema {
+public:
+	double value, alpha;
+	uint64_t count;
+
+	Ema( double a = 0 ): value(0), alpha(a), count(0) {}
+	void update( double x ) {
+		count++;
+		double a = 1.0 / count < alpha ? alpha : 1.0 / count;
+		value += a * (x - value);
+	}
+};
+
+
+// Restart policy interface
+class Restart {
+public:
+	virtual ~Restart() {}
+	// Start from scratch (beginning of the search or of a search mode)
+	virtual void reset( uint64_t conflicts ) = 0;
+	// Called after every conflict with the LBD of the learnt clause
+	// and the trail size at the conflict
+	virtual void conflict( int lbd, int trail_size, uint64_t conflicts ) = 0;
+	// Check whether to restart now
+	virtual bool restarting( uint64_t conflicts ) = 0;
+	// Called after a restart
+	virtual void restarted( uint64_t conflicts ) = 0;
+	// The number of restarts blocked by the trail size
+	uint64_t blocked;
+	Restart(): blocked(0) {}
+};
+
+
+// Glucose style blocking
+// Postpone restarts while the trail is much larger than usual,
+// since the solver may be close to a model
+class RestartBlocking {
+	bool enabled;
+	Ema trail;		// Average trail size at conflicts
+public:
+	RestartBlocking( bool e ): enabled(e), trail(1.0 / 5000) {}
+	bool blocking( int trail_size, uint64_t conflicts ) {
+		bool block = enabled && conflicts > 10000 && trail_size > 1.4 * trail.value;
+		trail.update(trail_size);
+		return block;
+	}
+};
+
+
+// Recent 50 LBDs against the global average
+class QueueRestart : public Restart {
+	int queue[50],			// Circled queue saved the recent 50 LBDs
+	    queue_size,			// The number of LBDs in this queue
+	    queue_pos;			// The position to save the next LBD
+	uint64_t fast_sum, slow_sum;	// Sum of the recent 50 and the global LBDs
+	uint64_t slow_count;		// The number of the global LBDs
+	RestartBlocking block;
+public:
+	QueueRestart( bool blocking ): slow_sum(0), slow_count(0), block(blocking) { reset(0); }
+	void reset( uint64_t conflicts );
+	void conflict( int lbd, int trail_size, uint64_t conflicts );
+	bool restarting( uint64_t conflicts );
+	void restarted( uint64_t conflicts ) { reset(conflicts); }
+};
+
+
+// Fast and slow exponential moving averages of LBDs
+class EmaRestart : public Restart {
+	Ema fast, slow;		// Averages of LBDs
+	uint64_t limit;		// The minimum number of conflicts to reach for the next restart
+	RestartBlocking block;
+public:
+	EmaRestart( bool blocking ): fast(1.0 / 32), slow(1e-5), limit(0), block(blocking) {}
+	void reset( uint64_t conflicts ) { limit = conflicts + 2; }
+	void conflict( int lbd, int trail_size, uint64_t conflicts );
+	bool restarting( uint64_t conflicts );
+	void restarted( uint64_t conflicts ) { limit = conflicts + 2; }
+};
+
+
+// Restart after a scheduled number of conflicts
+// (Luby, geometric, and reluctant doubling)
+class ScheduledRestart : public Restart {
+	int kind;
+	uint64_t interval;	// Current interval in conflicts
+	uint64_t limit;		// Conflicts to reach for the next restart
+	uint64_t luby_index;	// Index in the Luby sequence
+	uint64_t u, v;		// Reluctant doubling state [Based on Knuth]
+	void schedule( uint64_t conflicts );
+public:
+	ScheduledRestart( int k ): kind(k) { reset(0); }
+	void reset( uint64_t conflicts );
+	void conflict( int lbd, int trail_size, uint64_t conflicts ) {}
+	bool restarting( uint64_t conflicts ) { return conflicts >= limit; }
+	void restarted( uint64_t conflicts ) { schedule(conflicts); }
+};
+
+
+// Create a restart policy (RESTART_*)
+Restart *make_restart( int kind, bool blocking );
+// Luby sequence (1, 1, 2, 1, 1, 2, 4, ...)
+uint64_t luby( uint64_t i );
+
+#endif
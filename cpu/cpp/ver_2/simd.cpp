@@ -0,0 +1,85 @@
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+
+// One literal at a time (as the loop in propagate())
+static int find_scalar( const int *lits, int from, int to, const int8_t *value ) {
+	int k = from;
+	for ( ; k < to; k++ ) {
+		int l = lits[k];
+		if ( (l > 0 ? value[l] : -value[-l]) != -1 ) break;
+	}
+	return k;
+}
+
+#ifdef SIMD_X86
+
+// 8 literals per step
+// Gathers the 4 bytes at value + |l| and keeps the low one (sign extended),
+// negates it for negative literals and compares with -1 (false)
+__attribute__((target("avx2")))
+static int find_avx2( const int *lits, int from, int to, const int8_t *value ) {
+	const __m256i false_value = _mm256_set1_epi32(-1);
+	int k = from;
+	for ( ; k + 8 <= to; k += 8 ) {
+		__m256i l = _mm256_loadu_si256((const __m256i *)(lits + k));
+		__m256i v = _mm256_i32gather_epi32((const int *)value, _mm256_abs_epi32(l), 1);
+		v = _mm256_srai_epi32(_mm256_slli_epi32(v, 24), 24);
+		v = _mm256_sign_epi32(v, l);
+		int is_false = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, false_value)));
+		if ( is_false != 0xff ) return k + __builtin_ctz(~is_false);
+	}
+	return find_scalar(lits, k, to, value);
+}
+
+// 16 literals per step, the tail with masked loads
+__attribute__((target("avx512f")))
+static int find_avx512( const int *lits, int from, int to, const int8_t *value ) {
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i false_value = _mm512_set1_epi32(-1);
+	for ( int k = from; k < to; k += 16 ) {
+		__mmask16 lanes = to - k >= 16 ? 0xffff : (__mmask16)((1u << (to - k)) - 1);
+		__m512i l = _mm512_maskz_loadu_epi32(lanes, lits + k);
+		__m512i v = _mm512_mask_i32gather_epi32(zero, lanes, _mm512_maskz_abs_epi32(lanes, l), value, 1);
+		v = _mm512_maskz_srai_epi32(lanes, _mm512_maskz_slli_epi32(lanes, v, 24), 24);
+		v = _mm512_mask_sub_epi32(v, _mm512_cmplt_epi32_mask(l, zero), zero, v);
+		__mmask16 not_false = _mm512_mask_cmpneq_epi32_mask(lanes, v, false_value);
+		if ( not_false ) return k + __builtin_ctz(not_false);
+	}
+	return to;
+}
+
+int simd_supported() {
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx512f") ) return SIMD_AVX512;
+	if ( __builtin_cpu_supports("avx2") ) return SIMD_AVX2;
+	return SIMD_SCALAR;
+}
+
+#else
+
+int simd_supported() { return SIMD_SCALAR; }
+
+#endif
+
+
+FindNonFalse find_non_false = find_scalar;
+static int current = simd_select(SIMD_AVX512);
+
+int simd_select( int level ) {
+	int supported = simd_supported();
+	if ( level > supported ) level = supported;
+	find_non_false = find_scalar;
+#ifdef SIMD_X86
+	if ( level == SIMD_AVX2 ) find_non_false = find_avx2;
+	if ( level == SIMD_AVX512 ) find_non_false = find_avx512;
+#endif
+	current = level;
+	return level;
+}
+
+int simd_level() { return current; }
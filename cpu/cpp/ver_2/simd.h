@@ -0,0 +1,38 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+
+// Replacement watch search for long clauses in propagate()
+// find_non_false(lits, from, to, value) returns the position of the first literal
+// in lits[from, to) that is not false under value (per variable, 1:True; -1:False; 0:Undefine),
+// or 'to' if all of them are false.
+// The AVX-512 (16 literals per step) or AVX2 (8) kernel is selected at startup from the CPU
+// features, the scalar loop otherwise. Kernels gather 4 bytes per variable, so value needs
+// SIMD_PADDING readable bytes after the last variable.
+// Build with -DNO_SIMD to keep the scalar kernel only.
+
+#define SIMD_SCALAR 0
+#define SIMD_AVX2 1
+#define SIMD_AVX512 2
+#define SIMD_LEVELS 3
+
+#define SIMD_PADDING 4
+
+typedef int (*FindNonFalse)( const int *lits, int from, int to, const int8_t *value );
+
+extern FindNonFalse find_non_false;
+
+// Best kernel of this CPU
+int simd_supported();
+// Use the kernel of the given level (lowered to what the CPU supports), returns the level used
+int simd_select( int level );
+// Level in use
+int simd_level();
+
+static inline const char *simd_name( int level ) {
+	const char *names[SIMD_LEVELS] = { "scalar", "avx2", "avx512" };
+	return names[level];
+}
+
+#endif
@@ -1,3 +1,5 @@
+#include <string.h>
+#include <math.h>
 #include "solver.h"
 
 
@@ -26,6 +28,9 @@ static inline double timeCheckerCPU(void) {
         return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1000000;
 }
 
+// Set by a signal handler to stop solve() with UNSOLVED
+volatile sig_atomic_t solver_interrupted = 0;
+
 // Additional funcs for reading CNF file
 uint8_t *read_whitespace( uint8_t *p ) {
         // ASCII
@@ -43,66 +48,158 @@ uint8_t *read_until_new_line( uint8_t *p ) {
         return ++p;
 }
 
-uint8_t *read_int( uint8_t *p, int *i ) {
+// A decimal integer whose magnitude is at most 'limit' (a parse error otherwise)
+// limit <= (INT64_MAX - 9) / 10, so the digits never overflow before the check
+static inline uint8_t *read_number( uint8_t *p, int64_t *i, int64_t limit ) {
         bool sym = true;
-        *i = 0;
+        int64_t n = 0;
         p = read_whitespace(p);
         if ( *p == '-' ) {
                 sym = false;
                 ++p;
         }
         while ( *p >= '0' && *p <= '9' ) {
-                if ( *p == '\0' ) return p;
-                *i = *i * 10 + *p - '0';
+                n = n * 10 + *p - '0';
+                if ( n > limit ) printf("c PARSE ERROR(Integer overflow)!\n"), exit(1);
                 ++p;
         }
-        if ( !sym ) *i = -(*i);
+        *i = sym ? n : -n;
         return p;
 }
 
+uint8_t *read_int( uint8_t *p, int *i ) {
+        int64_t n;
+        p = read_number(p, &n, INT_MAX);
+        *i = (int)n;
+        return p;
+}
+
+uint8_t *read_int64( uint8_t *p, int64_t *i ) {
+        return read_number(p, i, (INT64_MAX - 9) / 10);
+}
+
 
 // Solver
+// Set default options
+Solver::Solver() {
+	heuristic = DECIDE_VSIDS;
+	mode = MODE_FOCUSED;
+	mode_switching = 0;
+	restart_kind[MODE_FOCUSED] = RESTART_QUEUE;
+	restart_kind[MODE_STABLE] = RESTART_RELUCTANT;
+	block_restarts = false;
+	conflict_limit = 0;
+	compress = false;
+	renumber = false;
+	relocate = false;
+	distance_before[0] = distance_before[1] = distance_after[0] = distance_after[1] = 0;
+	packed_clauses = 0;
+	progress_interval = 0;
+	perf_enabled = false;
+	proof = NULL;
+	proof_units = 0;
+	restarter[0] = restarter[1] = NULL;
+	value = local_best = saved = target = NULL;
+#ifdef VAR_AOS
+	var_data = NULL;
+#else
+	reason = NULL;
+	level = mark = NULL;
+#endif
+	activity = NULL;
+	watched_literals = NULL;
+
+	// Statistics
+	vars = 0;
+	clauses = origin_clauses = 0;
+	conflicts = decides = propagations = 0;
+	restarts = rephases = reductions = lbd_sum = 0;
+	mode_switches = 0;
+	for ( int m = 0; m < 2; m++ ) {
+		mode_conflicts[m] = mode_decides[m] = mode_propagations[m] = mode_restarts[m] = 0;
+		mode_time[m] = 0;
+	}
+	solve_start = -1, last_progress = 0;
+	last_conflicts = last_propagations = 0;
+	lbd_fast = Ema(1.0 / 32), lbd_slow = Ema(1.0 / 4096);
+	trace_start = 0;
+}
+
+// Release all memory
+Solver::~Solver() {
+	for ( int m = 0; m < 2; m++ ) delete restarter[m];
+	delete[] value;
+	delete[] local_best;
+	delete[] saved;
+	delete[] target;
+#ifdef VAR_AOS
+	delete[] var_data;
+#else
+	delete[] reason;
+	delete[] level;
+	delete[] mark;
+#endif
+	delete[] activity;
+	delete[] watched_literals;
+	if ( proof ) fclose(proof);
+}
+
 // Allocate memory and initialize the values
 void Solver::initialize() {
-    	value  = new int8_t[vars + 1];
+    	value  = new int8_t[vars + 1 + SIMD_PADDING]();
 	local_best = new int8_t[vars + 1];
 	saved = new int8_t[vars + 1];
-    	reason = new int[vars + 1];
+	target = new int8_t[vars + 1];
+#ifdef VAR_AOS
+	var_data = new VarData[vars + 1];
+#else
+    	reason = new CRef[vars + 1];
     	level = new int[vars + 1];
     	mark = new int[vars + 1];
+#endif
     	activity = new uint64_t[vars + 1];
-    	watched_literals = new std::vector<WL>[vars * 2 + 1]; // Two polarities
+    	watched_literals = new Watches[vars * 2 + 1]; // Two polarities
     	
-	conflicts = decides = propagations = 0;
-	restarts = rephases = reduces = 0;
+	reduces = 0;
     	threshold = propagated = time_stamp = 0;
-	fast_lbd_sum = lbd_queue_size = lbd_queue_pos = slow_lbd_sum = 0;
 
-	rephase_inc = 1e5, rephase_limit = 1e5, reduce_limit = 8192; // Heuristics
+	rephase_inc = REPHASE_FIRST, rephase_limit = REPHASE_FIRST, reduce_limit = REDUCE_FIRST; // Heuristics
 
-	vsids.initialize(activity);
+	// Mode switching starts in focused mode (VMTF)
+	if ( mode_switching ) mode = MODE_FOCUSED, heuristic = DECIDE_VMTF;
+	mode_inc = MODE_FIRST, mode_limit = MODE_FIRST;
+	for ( int m = 0; m < 2; m++ ) {
+		restarter[m] = make_restart(restart_kind[m], block_restarts);
+		restarter[m]->reset(0);
+	}
+	target_assigned = 0;
+
+	vsids.initialize(activity, vars);
     	for (int i = 1; i <= vars; i++) {
-        	value[i] = reason[i] = level[i] = mark[i] = local_best[i] = activity[i] = saved[i] = 0;
+        	value[i] = Reason(i) = Level(i) = Mark(i) = local_best[i] = activity[i] = saved[i] = target[i] = 0;
 		vsids.insert(i);
     	}
+	vmtf.initialize(vars);
 }
 
 // Assign true value to a certain literal
-void Solver::assign( int literal, int l, int cref ) {
+void Solver::assign( int literal, int l, CRef cref ) {
     	int var = abs(literal);
 	// Only make it ture
 	// The same literal but has opposite polarity gonna be false
     	value[var]  = literal > 0 ? 1 : -1;
-    	level[var]  = l;
-	reason[var] = cref;                                         
+    	Level(var)  = l;
+	Reason(var) = cref;                                         
     	trail.push_back(literal);
 }
 
 // Add a clause to the database
-int Solver::add_clause( std::vector<int> &c ) {                   
+CRef Solver::add_clause( std::vector<int> &c ) {                   
+	if ( clauseDB.size() >= (size_t)CREF_MAX ) printf("c ERROR(Too many clauses, build with -DINDEX64)!\n"), exit(1);
+	size_t headers = clauseDB.capacity();
     	clauseDB.push_back(Clause(c.size()));                          
     	
-	int id = clauseDB.size() - 1;                                
+	CRef id = clauseDB.size() - 1;                                
     	for ( int i = 0; i < (int)c.size(); i++ ) clauseDB[id][i] = c[i];
         
 	// There's two watched literals
@@ -110,25 +207,104 @@ int Solver::add_clause( std::vector<int> &c ) {
 	// We only assign True value
 	// If we assign c[0] as true, the only concern is -c[0]
 	// c[1] is a blocker for c[0] and vice versa
-    	WatchedLiterals(-c[0]).push_back(WL(id, c[1])); // watched_literals[vars-c[0]]                      
-    	WatchedLiterals(-c[1]).push_back(WL(id, c[0])); // watched_literals[vars-c[1]]
+    	WatchedLiterals(-c[0]).push_back(WL(id, c[1]), watch_pool); // watched_literals[vars-c[0]]                      
+    	WatchedLiterals(-c[1]).push_back(WL(id, c[0]), watch_pool); // watched_literals[vars-c[1]]
+	// The literals and any growth of the database count until the next full update
+	memory.add(MEM_CLAUSES, vector_bytes(clauseDB[id].literals) + (clauseDB.capacity() - headers) * sizeof(Clause));
 
     	return id;                                                      
 }
 
+// Compress an original clause (lits are sorted by variable)
+// Returns false if the encoding would not save a third of the words (decoding costs time in propagate())
+bool Solver::pack_clause( Clause &c, std::vector<int> &lits ) {
+	std::sort(lits.begin(), lits.end(), []( int a, int b ) { return abs(a) < abs(b); });
+	std::vector<uint8_t> bytes;
+	int var = 0;
+	for ( int i = 0; i < (int)lits.size(); i++ ) {
+		uint32_t x = (uint32_t)(abs(lits[i]) - var) << 1 | (lits[i] < 0);
+		var = abs(lits[i]);
+		while ( x >= 0x80 ) bytes.push_back((x & 0x7f) | 0x80), x >>= 7;
+		bytes.push_back(x);
+	}
+	size_t words = 3 + (bytes.size() + 3) / 4;
+	if ( 3 * words > 2 * lits.size() ) return false;
+
+	std::vector<int, HugeAllocator<int> > packed(words);
+	packed[0] = c[0];
+	packed[1] = c[1];
+	packed[2] = lits.size();
+	memcpy(&packed[3], bytes.data(), bytes.size());
+	c.literals.swap(packed);
+	c.packed = 1;
+	packed_clauses++;
+	return true;
+}
+
+// Literals with the watches first (decoded into 'unpacked' if compressed)
+const int *Solver::clause_literals( Clause &c, int &size ) {
+	if ( !c.packed ) {
+		size = c.literals.size();
+		return c.literals.data();
+	}
+	unpacked.clear();
+	unpacked.push_back(c[0]);
+	unpacked.push_back(c[1]);
+	const uint8_t *p = c.bytes();
+	int var = 0;
+	for ( int i = 0; i < c.literals[2]; i++ ) {
+		uint32_t x;
+		p = read_varint(p, x);
+		var += x >> 1;
+		int l = (x & 1) ? -var : var;
+		if ( l != c[0] && l != c[1] ) unpacked.push_back(l);
+	}
+	size = unpacked.size();
+	return unpacked.data();
+}
+
+// Replacement watch of a compressed clause:
+// the first literal that is not false apart from the watches (0 if there is none)
+static inline int packed_replacement( Clause &c, const int8_t *value ) {
+	const uint8_t *p = c.bytes();
+	int var = 0;
+	for ( int i = 0; i < c.literals[2]; i++ ) {
+		uint32_t x;
+		p = read_varint(p, x);
+		var += x >> 1;
+		int l = (x & 1) ? -var : var;
+		if ( Value(l) != -1 && l != c[0] && l != c[1] ) return l;
+	}
+	return 0;
+}
+
 // BCP (Boolean Constraint Propagation)
-int Solver::propagate() {
+CRef Solver::propagate() {
 	// This propagate style is fully based on MiniSAT
     	while ( propagated < (int)trail.size() ) { 
 		// 'p' is already assigned as true
 		// We now gonna only concern '-p'
         	int p = trail[propagated++];
+#if PREFETCH
+		// The watch list of the next literal
+		if ( propagated < (int)trail.size() ) __builtin_prefetch(WatchedLiterals(trail[propagated]).data());
+#endif
         	// Take an array of '-p'
-		std::vector<WL> &ws = WatchedLiterals(p);
+		Watches &ws = WatchedLiterals(p);
 		// Check all clauses that contains '-p'
 		int num_clauses = ws.size();
 		int j = 0;
 		for ( int i = 0; i < num_clauses;  ) {
+#if PREFETCH
+			// Clauses of the watchers ahead that are not satisfied by their blockers
+			// The header (where the literals are) comes first, so the literals are fetched later
+			if ( i + PREFETCH < num_clauses && Value(ws[i + PREFETCH].blocker) != 1 ) {
+				__builtin_prefetch(&clauseDB[ws[i + PREFETCH].clauseIdx]);
+			}
+			if ( PREFETCH > 1 && i + PREFETCH / 2 < num_clauses && Value(ws[i + PREFETCH / 2].blocker) != 1 ) {
+				__builtin_prefetch(clauseDB[ws[i + PREFETCH / 2].clauseIdx].literals.data());
+			}
+#endif
 			// To make the BCP progess fast
 			// Check whether a clause is already satisfied via blocker
 			// If then, move to the next clause that has '-p'
@@ -141,7 +317,7 @@ int Solver::propagate() {
 			// If we have to find a new wathced literal,
 			// We gonna move the literal's position to c[1]
             		// Make sure the false literal is 'c[1]'
-			int cref = ws[i].clauseIdx;
+			CRef cref = ws[i].clauseIdx;
 			Clause& c = clauseDB[cref];
 			int falseLiteral = -p; 
             		if ( c[0] == falseLiteral ) {
@@ -158,16 +334,37 @@ int Solver::propagate() {
 				continue;
             		}
 			// Look for a new watched literal in this clause
-			int k;
-			int sz = c.literals.size();
-            		for ( k = 2; (k < sz) && (Value(c[k]) == -1); k++ ); 
-			if ( k < sz ) {
+			int replacement = 0;
+			if ( c.packed ) replacement = packed_replacement(c, value);
+			else {
+				int k = 2;
+				int sz = c.literals.size();
+				if ( sz >= LONG_CLAUSE ) {
+					// Long clauses: several literals per step
+#ifdef NO_SAVED_POS
+					k = find_non_false(c.literals.data(), 2, sz, value);
+#else
+					// From the saved position to the end, then from c[2] to the saved position
+					k = find_non_false(c.literals.data(), c.pos, sz, value);
+					if ( k == sz ) {
+						k = find_non_false(c.literals.data(), 2, c.pos, value);
+						if ( k == c.pos ) k = sz;
+					}
+					if ( k < sz ) c.pos = k;
+#endif
+				}
+				else for ( ; (k < sz) && (Value(c[k]) == -1); k++ ); 
+				if ( k < sz ) {
+					// Move '-p' to the last position that has also false value
+					replacement = c[k];
+					c[k] = falseLiteral;
+				}
+			}
+			if ( replacement ) {
 				// Find it!
-				// Move '-p' to the last position that has also false value
-                		c[1] = c[k];
-				c[k] = falseLiteral;
+                		c[1] = replacement;
 				// Make c[0] as blocker
-                		WatchedLiterals(-c[1]).push_back(w);
+                		WatchedLiterals(-c[1]).push_back(w, watch_pool);
 			} else { 
 				// Couldn't find a new watched literal
 				// then, clause is unit under assignment
@@ -178,26 +375,111 @@ int Solver::propagate() {
                 		if ( Value(firstWP) == -1 ) { 
                     			while ( i < num_clauses ) ws[j++] = ws[i++];
 					// Shrink
-                    			ws.resize(j);
+                    			ws.shrink(j);
 					// Return the index of clause
                     			return cref;
                 		}
 				// Not conflict!
 				// then, assign!
                 		else {
-					assign(firstWP, level[abs(p)], cref);
+					assign(firstWP, Level(abs(p)), cref);
 					propagations++;
+					mode_propagations[mode]++;
 				}
 			}
             	}
 		// Shrink
-        	ws.resize(j);
+        	ws.shrink(j);
     	}
     	return -1;                                       
 }
 
+// Add a clause of the input (false if the formula is UNSAT)
+bool Solver::add_input_clause( std::vector<int> &c ) {
+	if ( c.size() == 0 ) return false;
+	else if ( c.size() == 1 ) {
+		if ( Value(c[0]) == -1 ) return false;
+		else if ( !Value(c[0]) ) assign(c[0], 0, -1);
+	}
+	else {
+		CRef id = add_clause(c);
+		if ( compress && (int)c.size() >= COMPRESS_MIN_SIZE ) pack_clause(clauseDB[id], c);
+	}
+	return true;
+}
+
+// Renumber the variables in breadth-first order of the variable-clause graph [Based on Cuthill-McKee]
+// and add the clauses of 'lits' (DIMACS literals, 0 after each clause) in the new numbering and in the visiting order,
+// so variables (value, level, watches) and clauses that occur together get close indices.
+// Each component starts at an unvisited variable of the smallest degree; the new variables of a clause are
+// numbered in increasing degree. Returns false if the formula is UNSAT.
+// Clause numbers and positions in 'lits' are CRefs (more than 2^31 - 1 literals need -DINDEX64).
+bool Solver::renumber_variables( std::vector<int> &lits ) {
+	// Occurrences of each variable (degree) and the clauses per variable
+	std::vector<CRef> clause_start, first(vars + 2, 0);
+	clause_start.push_back(0);
+	for ( CRef i = 0; i < (CRef)lits.size(); i++ ) {
+		if ( lits[i] ) first[abs(lits[i]) + 1]++;
+		else clause_start.push_back(i + 1);
+	}
+	CRef num_clauses = clause_start.size() - 1;
+	std::vector<CRef> degree(vars + 1);
+	for ( int v = 1; v <= vars; v++ ) degree[v] = first[v + 1], first[v + 1] += first[v];
+	std::vector<CRef> occurs(first[vars + 1]), fill(first.begin(), first.end() - 1);
+	for ( CRef c = 0; c < num_clauses; c++ ) {
+		for ( CRef i = clause_start[c]; lits[i]; i++ ) occurs[fill[abs(lits[i])]++] = c;
+	}
+
+	std::vector<int> starts(vars);
+	for ( int v = 1; v <= vars; v++ ) starts[v - 1] = v;
+	std::stable_sort(starts.begin(), starts.end(), [&degree]( int a, int b ) { return degree[a] < degree[b]; });
+
+	std::vector<int> to_new(vars + 1, 0), order;
+	std::vector<CRef> clause_order;
+	std::vector<bool> visited(num_clauses, false);
+	order.reserve(vars);
+	clause_order.reserve(num_clauses);
+	for ( int s = 0; s < vars; s++ ) {
+		if ( to_new[starts[s]] ) continue;
+		order.push_back(starts[s]);
+		to_new[starts[s]] = order.size();
+		for ( size_t head = order.size() - 1; head < order.size(); head++ ) {
+			int v = order[head];
+			for ( CRef o = first[v]; o < first[v + 1]; o++ ) {
+				CRef c = occurs[o];
+				if ( visited[c] ) continue;
+				visited[c] = true;
+				clause_order.push_back(c);
+				size_t added = order.size();
+				for ( CRef i = clause_start[c]; lits[i]; i++ ) {
+					int u = abs(lits[i]);
+					if ( !to_new[u] ) order.push_back(u), to_new[u] = order.size();
+				}
+				std::sort(order.begin() + added, order.end(), [&degree]( int a, int b ) { return degree[a] < degree[b]; });
+				for ( size_t i = added; i < order.size(); i++ ) to_new[order[i]] = i + 1;
+			}
+		}
+	}
+	// Empty clauses are not reached
+	for ( CRef c = 0; c < num_clauses; c++ ) if ( !visited[c] ) clause_order.push_back(c);
+
+	dimacs_var.assign(vars + 1, 0);
+	for ( int v = 1; v <= vars; v++ ) dimacs_var[to_new[v]] = v;
+
+	std::vector<int> clause;
+	for ( CRef n = 0; n < num_clauses; n++ ) {
+		clause.clear();
+		for ( CRef i = clause_start[clause_order[n]]; lits[i]; i++ ) {
+			clause.push_back(lits[i] > 0 ? to_new[lits[i]] : -to_new[-lits[i]]);
+		}
+		if ( !add_input_clause(clause) ) return false;
+	}
+	return true;
+}
+
 // Read CNF file
 int Solver::parse( char *filename ) {
+	PROFILE_START(parse);
     	FILE *f_data = fopen(filename, "r");  
 
 	// Get the file size first
@@ -208,12 +490,15 @@ int Solver::parse( char *filename ) {
 	fseek(f_data, 0, SEEK_SET);
 	uint8_t *data = new uint8_t[file_len + 1];
 	uint8_t *p = data;
+	memory.set(MEM_PARSER, file_len + 1);
 	fread(data, sizeof(uint8_t), file_len, f_data);
 	fclose(f_data);                                             
 	data[file_len] = '\0';
 
 	// Save a clause temporarily to go to the database
     	std::vector<int> buffer;
+	// All clauses, each followed by 0 (--renumber)
+	std::vector<int> pending;
 
 	// Parse the file
 	while ( *p != '\0' ) {
@@ -227,7 +512,9 @@ int Solver::parse( char *filename ) {
 			     (*(p + 3) == 'n') && (*(p + 4) == 'f') ) {
                 		p += 5; 
 				p = read_int(p, &vars); 
-				p = read_int(p, &clauses);
+				p = read_int64(p, &clauses);
+				if ( vars < 0 || vars > MAX_VARS ) printf("c PARSE ERROR(Too many variables)!\n"), exit(1);
+				if ( clauses < 0 || clauses > CREF_MAX ) printf("c PARSE ERROR(Too many clauses, build with -DINDEX64)!\n"), exit(1);
                 		initialize();
             		} 
             		else printf("PARSE ERROR(Unexpected Char)!\n"), exit(2);
@@ -240,38 +527,73 @@ int Solver::parse( char *filename ) {
                 			printf("c PARSE ERROR(Unexpected EOF)!\n");
 					exit(1);
 				}
+				else if ( abs(dimacs_lit) > vars ) {
+                			printf("c PARSE ERROR(Literal out of range)!\n");
+					exit(1);
+				}
 				else buffer.push_back(dimacs_lit);
 			}
 			else {                                                       
-                		if ( buffer.size() == 0 ) return 20;
-				else if ( buffer.size() == 1 ) {
-					if ( Value(buffer[0]) == -1 ) return 20;
-					else if ( !Value(buffer[0]) ) assign(buffer[0], 0, -1);
+				if ( renumber ) {
+					// Added after parsing, in the new numbering
+					pending.insert(pending.end(), buffer.begin(), buffer.end());
+					pending.push_back(0);
+				}
+				else if ( !add_input_clause(buffer) ) {
+					if ( proof ) proof_clause(NULL, 0, false);
+					delete[] data;
+					memory.set(MEM_PARSER, 0);
+					PROFILE_STOP(parse, PHASE_PARSE);
+					return 20;
 				}
-                		else add_clause(buffer); 
 
                 		buffer.clear();                                        
             		}
         	}
     	}
+	if ( renumber ) {
+		if ( pending.size() > (size_t)CREF_MAX ) printf("c PARSE ERROR(Too many literals, build with -DINDEX64)!\n"), exit(1);
+		memory.set(MEM_PARSER, file_len + 1 + vector_bytes(pending));
+		if ( !renumber_variables(pending) ) {
+			if ( proof ) proof_clause(NULL, 0, false);
+			delete[] data;
+			memory.set(MEM_PARSER, 0);
+			PROFILE_STOP(parse, PHASE_PARSE);
+			return 20;
+		}
+	}
     	origin_clauses = clauseDB.size();
-    	return ( propagate() == -1 ? 0 : 20 );             
+	account_memory();
+	delete[] data;
+	memory.set(MEM_PARSER, 0);
+	int res = ( propagate() == -1 ? 0 : 20 );
+	if ( res == 20 && proof ) proof_clause(NULL, 0, false);
+	PROFILE_STOP(parse, PHASE_PARSE);
+    	return res;
 }
 
-// Pick decision variable based on VSIDS
+// Pick decision variable based on VSIDS or VMTF
 int Solver::decide() {      
     	int next = -1;
-	while ( next == -1 || Value(next) != 0 ) {
+	if ( heuristic == DECIDE_VMTF ) {
+		next = vmtf.pick(value);
+		if ( !next ) return 10;
+	}
+	else while ( next == -1 || Value(next) != 0 ) {
         	if (vsids.empty()) return 10;
         	else next = vsids.pop();
     	}
     	decVarInTrail.push_back(trail.size());
     	
 	// If there's saved one (polarity), use that
-	if ( saved[next] ) next *= saved[next];
+	// Stable mode prefers the target phase
+	if ( mode == MODE_STABLE && target[next] ) next *= target[next];
+	else if ( saved[next] ) next *= saved[next];
     	assign(next, decVarInTrail.size(), -1);
+	SAT_PROBE2(decide, dimacs(next), decVarInTrail.size());
 
     	decides++;
+	mode_decides[mode]++;
 	return 0;
 }
 
@@ -283,14 +605,24 @@ void Solver::update_score( int var, uint64_t amount ) {
 		for ( int i = 1; i <= vars; i ++ ) {
 			activity[i] /= 2;
 		}
+		vsids.refresh();
 		activity[var] += amount/2;
 	} else activity[var] += amount;
 	// Update Heap
     	if ( vsids.inHeap(var) ) vsids.update(var);
 }
 
+// Move variables to the front of VMTF queue
+void Solver::bump_queue( std::vector<int> &vars ) {
+	// Keep the relative order of the bumped variables
+	// by bumping the least recently bumped one first
+	std::sort(vars.begin(), vars.end(), 
+		  [this]( int a, int b ) { return vmtf.bumped(a) < vmtf.bumped(b); });
+	for ( int i = 0; i < (int)vars.size(); i++ ) vmtf.bump(vars[i], value[vars[i]] == 0);
+}
+
 // Conflict analysis
-int Solver::analyze( int conflict, int &backtrackLevel, int &lbd ) {
+int Solver::analyze( CRef conflict, int &backtrackLevel, int &lbd ) {
 	// This analysis is based on 'First UIP Learning Method'
 	// Unit Implication Points
 	// The main motivation for identifying UIPs is to reduce the size of learnt clauses
@@ -298,10 +630,15 @@ int Solver::analyze( int conflict, int &backtrackLevel, int &lbd ) {
 	// there is a UIP at decision level d,
 	// when the number of literals in intermediate clause
 	// assigned at decision level d is 1
+	// Marks are compared with time_stamp, so they are cleared before it wraps
+	if ( time_stamp >= INT_MAX - 2 ) {
+		for ( int v = 1; v <= vars; v++ ) Mark(v) = 0;
+		time_stamp = 0;
+	}
     	++time_stamp;
     	learnt.clear();
     	Clause &c = clauseDB[conflict]; 
-	int conflictLevel = level[abs(c[0])];
+	int conflictLevel = Level(abs(c[0]));
 
     	if ( conflictLevel == 0 ) return 20; // UNSAT
 	else {
@@ -319,27 +656,28 @@ int Solver::analyze( int conflict, int &backtrackLevel, int &lbd ) {
 		std::vector<int> bump;
 		do {
 			// First UIP learning method
-			Clause &c = clauseDB[conflict];
+			int size;
+			const int *c = clause_literals(clauseDB[conflict], size);
 			// Mark the literals
-			for ( int i = (resolve_lit == 0 ? 0 : 1); i < (int)c.literals.size(); i++ ) {
+			for ( int i = (resolve_lit == 0 ? 0 : 1); i < size; i++ ) {
 				int var = abs(c[i]);
-				if ( mark[var] != time_stamp && level[var] > 0 ) {
+				if ( Mark(var) != time_stamp && Level(var) > 0 ) {
 					// Update score (step 1)
-					update_score(var, 2);
+					if ( heuristic == DECIDE_VSIDS ) update_score(var, 2);
 					bump.push_back(var);
-					mark[var] = time_stamp;
-					if ( level[var] >= conflictLevel ) should_visit_ct++;
+					Mark(var) = time_stamp;
+					if ( Level(var) >= conflictLevel ) should_visit_ct++;
 					else learnt.push_back(c[i]);
 				}
 			}
 			// Find the last marked literal in the trail to do resolution
 			do {
-				while ( mark[abs(trail[index--])] != time_stamp );
+				while ( Mark(abs(trail[index--])) != time_stamp );
 				resolve_lit = trail[index + 1];
-			} while ( level[abs(resolve_lit)] < conflictLevel );
+			} while ( Level(abs(resolve_lit)) < conflictLevel );
 			
-			conflict = reason[abs(resolve_lit)];
-			mark[abs(resolve_lit)] = 0;
+			conflict = Reason(abs(resolve_lit));
+			Mark(abs(resolve_lit)) = 0;
 			should_visit_ct--;
 		} while ( should_visit_ct > 0 );
 
@@ -349,40 +687,30 @@ int Solver::analyze( int conflict, int &backtrackLevel, int &lbd ) {
 		
 		// Calculate LBD
 		for ( int i = 0; i < (int)learnt.size(); i++ ) {
-			int l = level[abs(learnt[i])];
-			if ( l && mark[l] != time_stamp ) {
-				mark[l] = time_stamp;
+			int l = Level(abs(learnt[i]));
+			if ( l && Mark(l) != time_stamp ) {
+				Mark(l) = time_stamp;
 				++lbd;
 			}
 		}
 
-		if ( lbd_queue_size < 50 ) lbd_queue_size++;
-		else fast_lbd_sum -= lbd_queue[lbd_queue_pos];
-		
-		// Sum of the recent 50 LBDs
-		fast_lbd_sum += lbd;
-		lbd_queue[lbd_queue_pos++] = lbd;
-		
-		// Sum of the global LBDs
-		if ( lbd_queue_pos == 50 ) lbd_queue_pos = 0;
-		slow_lbd_sum += (lbd > 50 ? 50 : lbd);
-			
 		// Decide backtrack level
 		if ( learnt.size() == 1 ) backtrackLevel = 0;
 		else {
 			int max_id = 1;
 			for ( int i = 2; i < (int)learnt.size(); i++ ) {
-				if ( level[abs(learnt[i])] > level[abs(learnt[max_id])] ) max_id = i;
+				if ( Level(abs(learnt[i])) > Level(abs(learnt[max_id])) ) max_id = i;
 			}
 			int p = learnt[max_id];
 			learnt[max_id] = learnt[1];
 			learnt[1] = p;
-			backtrackLevel = level[abs(p)];
+			backtrackLevel = Level(abs(p));
 		}
 
 		// Update score (step 2)
-		for ( int i = 0; i < (int)bump.size(); i++ ) {   
-			if ( level[bump[i]] >= backtrackLevel - 1 ) update_score(bump[i], 4);
+		if ( heuristic == DECIDE_VMTF ) bump_queue(bump);
+		else for ( int i = 0; i < (int)bump.size(); i++ ) {   
+			if ( Level(bump[i]) >= backtrackLevel - 1 ) update_score(bump[i], 4);
 		}
 	}
     	return 0;
@@ -397,8 +725,9 @@ void Solver::backtrack( int backtrackLevel ) {
 			value[v] = 0;
 			// Phase saving
 			saved[v] = trail[i] > 0 ? 1 : -1;
-			// Store variable back to VSIDS heap
-			if ( !vsids.inHeap(v) ) vsids.insert(v);
+			// Store variable back to VSIDS heap or update VMTF cursor
+			if ( heuristic == DECIDE_VMTF ) vmtf.unassign(v);
+			else if ( !vsids.inHeap(v) ) vsids.insert(v);
 		}
 		propagated = decVarInTrail[backtrackLevel];
 		trail.resize(propagated);
@@ -406,11 +735,49 @@ void Solver::backtrack( int backtrackLevel ) {
 	}
 }
 
+// Check whether to restart in the current mode
+bool Solver::restarting() {
+	return restarter[mode]->restarting(conflicts);
+}
+
 // Do restart
 void Solver::restart() {
-    	fast_lbd_sum = lbd_queue_size = lbd_queue_pos = 0;
-    	backtrack(decVarInTrail.size());
+	// Back to level 0: the policies only decide when
+    	backtrack(0);
+	restarter[mode]->restarted(conflicts);
 	restarts++;
+	mode_restarts[mode]++;
+	SAT_PROBE2(restart, restarts, decVarInTrail.size());
+	if ( trace.enabled() ) trace_event(EVENT_RESTART);
+}
+
+// Alternate focused and stable modes
+void Solver::switch_mode() {
+	double now = timeCheckerCPU();
+	mode_time[mode] += now - mode_start;
+	mode_start = now;
+
+	backtrack(0);
+	if ( mode == MODE_FOCUSED ) {
+		// Stable mode: VSIDS, target phases, and rare restarts
+		mode = MODE_STABLE;
+		heuristic = DECIDE_VSIDS;
+		// Unassigned variables were not put back to the heap while VMTF was used
+		for ( int i = 1; i <= vars; i++ ) if ( !value[i] && !vsids.inHeap(i) ) vsids.insert(i);
+	} else {
+		// Focused mode: VMTF and frequent restarts
+		mode = MODE_FOCUSED;
+		heuristic = DECIDE_VMTF;
+		vmtf.reset_search();
+		// Each pair of modes gets a twice larger budget
+		mode_inc *= 2;
+	}
+	restarter[mode]->reset(conflicts);
+	target_assigned = 0;
+	mode_limit = conflicts + mode_inc;
+	mode_switches++;
+	SAT_PROBE2(mode, mode, conflicts);
+	if ( trace.enabled() ) trace_event(EVENT_MODE);
 }
 
 // Do rephase
@@ -418,7 +785,12 @@ void Solver::rephase() {
 	// This rephase style is fully based on CaDiCaL
 	if ( (rephases / 2) == 1 ) for ( int i = 1; i <= vars; i++ ) saved[i] = local_best[i];
 	else for ( int i = 1; i <= vars; i++ ) saved[i] = -local_best[i];
-	backtrack(decVarInTrail.size());
+	for ( int i = 1; i <= vars; i++ ) target[i] = saved[i];
+	target_assigned = 0;
+	// The new phases take effect from the next decision on
+	backtrack(0);
+	if ( trace.enabled() ) trace_event(EVENT_REPHASE);
+	SAT_PROBE2(rephase, rephases, conflicts);
 	rephase_inc *= 2;
 	rephase_limit = conflicts + rephase_inc;
 	rephases++;
@@ -429,18 +801,34 @@ void Solver::reduce() {
 	// Go back to the first decision level first
     	backtrack(0);
 
+	// Level 0 literals become units of the proof before their reasons may be deleted
+	if ( proof ) {
+		for ( ; proof_units < (int)trail.size(); proof_units++ ) proof_clause(&trail[proof_units], 1, false);
+	}
+
     	reduces = 0;
+	reductions++;
 	reduce_limit += 512;
+	if ( trace.enabled() ) trace_event(EVENT_REDUCE);
+	double header_distance, literal_distance;
+	if ( relocate ) {
+		watch_distance(header_distance, literal_distance);
+		distance_before[0] += header_distance, distance_before[1] += literal_distance;
+	}
     	
-	int new_size = origin_clauses;
-	int old_size = clauseDB.size();
+	CRef new_size = origin_clauses;
+	CRef old_size = clauseDB.size();
 
 	reduceMap.resize(old_size);
+	for ( CRef i = 0; i < origin_clauses; i++ ) reduceMap[i] = i;
 	
 	// Random delete 50% bad clauses (LBD>=5) 
 	// Reducing based on Literal Block Distances
-    	for ( int i = origin_clauses; i < old_size; i++ ) { 
-        	if ( clauseDB[i].lbd >= 5 && rand_generator() == 0 ) reduceMap[i] = -1;
+    	for ( CRef i = origin_clauses; i < old_size; i++ ) { 
+        	if ( clauseDB[i].lbd >= 5 && rand_generator() == 0 ) {
+			reduceMap[i] = -1;
+			if ( proof ) proof_clause(clauseDB[i].literals.data(), clauseDB[i].literals.size(), true);
+		}
         	else {
             		if ( new_size != i ) clauseDB[new_size] = clauseDB[i];
             		reduceMap[i] = new_size++;
@@ -449,6 +837,46 @@ void Solver::reduce() {
 
 	// Resize the clause database
     	clauseDB.resize(new_size, Clause(0));
+
+	// Relocate the clauses in the order propagate() is likely to visit them:
+	// the watch lists of the variables by score (VSIDS activity or VMTF bump order),
+	// the literal of the saved phase first (its watch list is traversed when it is assigned).
+	// Original clauses stay before the learnt ones; only their headers move, learnt clauses also get
+	// fresh literal storage in the new order.
+	if ( relocate ) {
+		std::vector<int> vars_by_score(vars);
+		for ( int v = 1; v <= vars; v++ ) vars_by_score[v - 1] = v;
+		if ( heuristic == DECIDE_VSIDS ) {
+			std::sort(vars_by_score.begin(), vars_by_score.end(), [this]( int a, int b ) { return activity[a] > activity[b]; });
+		}
+		else std::sort(vars_by_score.begin(), vars_by_score.end(), [this]( int a, int b ) { return vmtf.bumped(a) > vmtf.bumped(b); });
+
+		std::vector<CRef> position(new_size, -1), order(new_size);
+		CRef next_original = 0, next_learnt = origin_clauses;
+		for ( int n = 0; n < vars; n++ ) {
+			int v = vars_by_score[n];
+			int lit = saved[v] < 0 ? -v : v;
+			for ( int side = 0; side < 2; side++, lit = -lit ) {
+				Watches &ws = WatchedLiterals(lit);
+				for ( int i = 0; i < (int)ws.size(); i++ ) {
+					CRef c = reduceMap[ws[i].clauseIdx];
+					if ( c == -1 || position[c] >= 0 ) continue;
+					position[c] = c < origin_clauses ? next_original++ : next_learnt++;
+				}
+			}
+		}
+		for ( CRef c = 0; c < new_size; c++ ) {
+			if ( position[c] < 0 ) position[c] = c < origin_clauses ? next_original++ : next_learnt++;
+			order[position[c]] = c;
+		}
+		std::vector<Clause, HugeAllocator<Clause> > moved(new_size, Clause(0));
+		for ( CRef n = 0; n < new_size; n++ ) {
+			if ( n < origin_clauses ) moved[n] = std::move(clauseDB[order[n]]);
+			else moved[n] = clauseDB[order[n]];
+		}
+		clauseDB.swap(moved);
+		for ( CRef i = 0; i < old_size; i++ ) if ( reduceMap[i] != -1 ) reduceMap[i] = position[reduceMap[i]];
+	}
     	
 	// Update the array of watched literals
 	for ( int v = -vars; v <= vars; v++ ) {
@@ -458,43 +886,105 @@ void Solver::reduce() {
 		int new_sz = 0;
 
         	for ( int i = 0; i < old_sz; i++ ) {
-            		int old_idx = WatchedLiterals(v)[i].clauseIdx;
-            		int new_idx = old_idx < origin_clauses ? old_idx : reduceMap[old_idx];
+            		CRef old_idx = WatchedLiterals(v)[i].clauseIdx;
+            		CRef new_idx = reduceMap[old_idx];
             		if ( new_idx != -1 ) {
                 		WatchedLiterals(v)[i].clauseIdx = new_idx;
                 		if (new_sz != i) WatchedLiterals(v)[new_sz] = WatchedLiterals(v)[i];
                 		new_sz++;
             		}
         	}
-        	WatchedLiterals(v).resize(new_sz);
+        	WatchedLiterals(v).shrink(new_sz);
     	}
+	// Lay the shrunk lists out again in literal order
+	watch_pool.compact(watched_literals, 2 * vars + 1);
+	if ( relocate ) {
+		watch_distance(header_distance, literal_distance);
+		distance_after[0] += header_distance, distance_after[1] += literal_distance;
+	}
+	// The clauses were added up since the last update; now count what is left
+	account_memory();
+	SAT_PROBE2(reduce, reductions, new_size - origin_clauses);
+}
+
+// Average distance in bytes between the clauses of consecutive watchers (headers and literals)
+// The geometric mean of 1 + distance, since a few far pairs would dominate the arithmetic mean
+void Solver::watch_distance( double &headers, double &literals ) {
+	double h = 0, l = 0;
+	int64_t pairs = 0;
+	for ( int v = -vars; v <= vars; v++ ) {
+		Watches &ws = WatchedLiterals(v);
+		for ( int i = 1; i < (int)ws.size(); i++ ) {
+			const Clause &a = clauseDB[ws[i - 1].clauseIdx], &b = clauseDB[ws[i].clauseIdx];
+			h += log2(1 + llabs((const char *)&a - (const char *)&b));
+			l += log2(1 + llabs((const char *)a.literals.data() - (const char *)b.literals.data()));
+			pairs++;
+		}
+	}
+	headers = pairs ? exp2(h / pairs) - 1 : 0;
+	literals = pairs ? exp2(l / pairs) - 1 : 0;
 }
 
 // Solver
 int Solver::solve() {
     	int res = 0;
 	double processStart = timeCheckerCPU();
+	double processTime = 0;
+	mode_start = last_progress = solve_start = processStart;
+	trace_start = profile_wall();
+	if ( perf_enabled && perf.open() ) {
+		perf.read(perf_start);
+		// Events per phase only with rdpmc (a system call per read would dwarf short phases)
+		if ( perf.user_readable() ) profiler.perf = &perf;
+	}
+	unsigned iterations = 0;
     	
 	while (!res) {
-		double processFinish = timeCheckerCPU();
-		double processTime = processFinish - processStart;
+		// Check the time (a system call) only every 256 iterations
+		if ( (++iterations & 255) == 0 ) {
+			double processFinish = timeCheckerCPU();
+			processTime = processFinish - processStart;
+			if ( progress_interval > 0 && processFinish - last_progress >= progress_interval ) {
+				progress(processFinish);
+			}
+		}
 
-		if ( processTime < 2000 ) {
-			int cref = propagate();
+		if ( processTime < 2000 && (!conflict_limit || conflicts < conflict_limit) && !solver_interrupted ) {
+			PROFILE_START(propagate);
+			CRef cref = propagate();
+			PROFILE_STOP(propagate, PHASE_PROPAGATE);
 		
 			// Find a conflict
 			if ( cref != -1 ) {
 				int backtrackLevel = 0; 
 				int lbd = 0;
+				SAT_PROBE3(conflict, conflicts, decVarInTrail.size(), trail.size());
 				
+				PROFILE_START(analyze);
 				res = analyze(cref, backtrackLevel, lbd);
+				PROFILE_STOP(analyze, PHASE_ANALYZE);
 			
 				if ( res == 20 ) {
 					// Find a conflict in 0 decision level
 					// UNSAT
+					if ( proof ) proof_clause(NULL, 0, false);
 					break;
 				} else {
+					PROFILE_START(learn);
+					// Both restart policies keep their averages up to date
+					for ( int m = 0; m < 2; m++ ) restarter[m]->conflict(lbd, trail.size(), conflicts);
+
+					// Update the target phase with the conflict-free part of the trail
+					if ( mode == MODE_STABLE && decVarInTrail.back() > target_assigned ) {
+						target_assigned = decVarInTrail.back();
+						for ( int i = 0; i < target_assigned; i++ ) target[abs(trail[i])] = trail[i] > 0 ? 1 : -1;
+					}
+					PROFILE_PAUSE(learn, PHASE_LEARN);
+					PROFILE_START(backtrack);
 					backtrack(backtrackLevel);
+					PROFILE_STOP(backtrack, PHASE_BACKTRACK);
+					PROFILE_START(learn2);
+					if ( proof ) proof_clause(learnt.data(), learnt.size(), false);
 				
 					if ( learnt.size() == 1 ) {
 						// Learnt a clause (unit)
@@ -504,49 +994,258 @@ int Solver::solve() {
 					} else {
 						// Learnt a clause (not unit)
 						// Add a clause to clause database
-						int cref = add_clause(learnt);
+						CRef cref = add_clause(learnt);
 						clauseDB[cref].lbd = lbd;
 						// The learnt clause implies the assignment of the UIP variable
 						assign(learnt[0], backtrackLevel, cref); 
 					}
+					SAT_PROBE3(learnt, learnt.size(), lbd, backtrackLevel);
 
 					// var_decay for locality
-					for ( int i = 1; i <= vars; i ++ ) if ( activity[i] != 0 ) activity[i] -= 1;
+					if ( heuristic == DECIDE_VSIDS ) {
+						for ( int i = 1; i <= vars; i ++ ) if ( activity[i] != 0 ) activity[i] -= 1;
+						vsids.decay();
+					}
 
 					++conflicts, ++reduces;
+					lbd_sum += lbd;
+					mode_conflicts[mode]++;
+
+					// Sample every trace.interval conflicts
+					if ( trace.enabled() ) {
+						lbd_fast.update(lbd), lbd_slow.update(lbd);
+						if ( conflicts >= trace.next ) {
+							trace_event(EVENT_SAMPLE);
+							trace.next += trace.interval;
+						}
+					}
 				
 					// Update the local-best phase
 					if ( (int)trail.size() > threshold ) {
 						threshold = trail.size();
 						for ( int i = 1; i < vars + 1; i++ ) local_best[i] = value[i];
 					}
+					PROFILE_STOP(learn2, PHASE_LEARN);
 				}
 			} else if ( reduces >= reduce_limit ) {
+				PROFILE_START(reduce);
 				reduce();
-			} else if ( lbd_queue_size == 50 && fast_lbd_sum/lbd_queue_size > slow_lbd_sum/conflicts ) {
-				// We proposed a new simple heuristic for restarting scheme
+				PROFILE_STOP(reduce, PHASE_REDUCE);
+			} else if ( mode_switching && conflicts >= mode_limit ) {
+				PROFILE_START(mode);
+				switch_mode();
+				PROFILE_STOP(mode, PHASE_MODE);
+			} else if ( restarting() ) {
+				PROFILE_START(restart);
 				restart();
+				PROFILE_STOP(restart, PHASE_RESTART);
 			} else if ( conflicts >= rephase_limit ) {
+				PROFILE_START(rephase);
 				rephase();
-			} else res = decide();
+				PROFILE_STOP(rephase, PHASE_REPHASE);
+			} else {
+				PROFILE_START(decide);
+				res = decide();
+				PROFILE_STOP(decide, PHASE_DECIDE);
+			}
 		} else res = 30;
 	}
 
-	if ( res == 10 || res == 20 ) {
-		double processFinal = timeCheckerCPU();
-		double processTimeFinal = processFinal - processStart;
-		printf( "Elapsed Time (CPU): %.2f\n", processTimeFinal );
-        printf( "Conflicts: %d\n", conflicts );
-		printf( "Decisions: %d\n", decides );
-		printf( "Propagations: %d\n", propagations );
-		printf( "Evaluations: %d\n", propagations + decides );
+	if ( trace.enabled() ) {
+		trace_event(EVENT_END);
+		trace.close();
 	}
+	report(res);
 
 	return res;
 }
 
+// Print statistics (every exit path)
+void Solver::report( int res ) {
+	double now = timeCheckerCPU();
+	const char *result = res == 10 ? "SATISFIABLE" : res == 20 ? "UNSATISFIABLE" : "UNSOLVED";
+	int64_t learnts = clauseDB.size() - origin_clauses;
+	int64_t blocked = restarter[0] ? restarter[MODE_FOCUSED]->blocked + restarter[MODE_STABLE]->blocked : 0;
+	if ( solve_start >= 0 ) mode_time[mode] += now - mode_start, mode_start = now;
+
+	std::vector<Stat> s;
+	if ( stats.get_format() != STATS_TEXT ) s.push_back(Stat("result", "Result", result));
+	s.push_back(Stat("time", "Elapsed Time (CPU)", solve_start >= 0 ? now - solve_start : 0.0));
+	s.push_back(Stat("conflicts", "Conflicts", conflicts));
+	s.push_back(Stat("decisions", "Decisions", decides));
+	s.push_back(Stat("propagations", "Propagations", propagations));
+	s.push_back(Stat("evaluations", "Evaluations", propagations + decides));
+	s.push_back(Stat("restarts", "Restarts", restarts));
+	if ( block_restarts ) s.push_back(Stat("blocked_restarts", "Blocked restarts", blocked));
+	s.push_back(Stat("rephases", "Rephases", rephases));
+	s.push_back(Stat("reductions", "Reductions", reductions));
+	s.push_back(Stat("learnts", "Learnt clauses", learnts));
+	s.push_back(Stat("average_lbd", "Average LBD", conflicts ? (double)lbd_sum / conflicts : 0.0));
+	s.push_back(Stat("total_time", "Total Time (CPU)", now));
+	s.push_back(Stat("memory_mb", "Memory (MB)", peak_memory_mb()));
+
+	// Live and peak MB per data structure
+	static const char *live_keys[MEM_STRUCTURES] = { "memory_variables_mb", "memory_clauses_mb",
+		"memory_watchers_mb", "memory_trail_mb", "memory_heap_mb", "memory_queue_mb", "memory_parser_mb" };
+	static const char *live_labels[MEM_STRUCTURES] = { "Memory variables (MB)", "Memory clauses (MB)",
+		"Memory watchers (MB)", "Memory trail (MB)", "Memory heap (MB)", "Memory queue (MB)", "Memory parser (MB)" };
+	static const char *peak_keys[MEM_STRUCTURES] = { "peak_variables_mb", "peak_clauses_mb",
+		"peak_watchers_mb", "peak_trail_mb", "peak_heap_mb", "peak_queue_mb", "peak_parser_mb" };
+	static const char *peak_labels[MEM_STRUCTURES] = { "Peak variables (MB)", "Peak clauses (MB)",
+		"Peak watchers (MB)", "Peak trail (MB)", "Peak heap (MB)", "Peak queue (MB)", "Peak parser (MB)" };
+	account_memory();
+	for ( int i = 0; i < MEM_STRUCTURES; i++ ) {
+		s.push_back(Stat(live_keys[i], live_labels[i], memory.live[i] / 1048576.0));
+		s.push_back(Stat(peak_keys[i], peak_labels[i], memory.peak[i] / 1048576.0));
+	}
+	if ( compress ) s.push_back(Stat("compressed_clauses", "Compressed clauses", packed_clauses));
+	if ( relocate ) {
+		// Averages over the reduces: before (as propagate() saw the clauses) and after the relocation
+		double n = reductions ? reductions : 1;
+		s.push_back(Stat("watch_distance_headers_before", "Watch distance headers before (bytes)", distance_before[0] / n));
+		s.push_back(Stat("watch_distance_headers_after", "Watch distance headers after (bytes)", distance_after[0] / n));
+		s.push_back(Stat("watch_distance_literals_before", "Watch distance literals before (bytes)", distance_before[1] / n));
+		s.push_back(Stat("watch_distance_literals_after", "Watch distance literals after (bytes)", distance_after[1] / n));
+	}
+	if ( huge_arena.mode != HUGE_OFF ) {
+		int64_t anon = huge_anon_bytes();
+		s.push_back(Stat("huge_pages", "Huge pages", HugeArena::name(huge_arena.mode)));
+		s.push_back(Stat("huge_mapped_mb", "Huge regions (MB)", huge_arena.mapped / 1048576.0));
+		s.push_back(Stat("hugetlb_mapped_mb", "Huge regions from hugetlbfs (MB)", huge_arena.hugetlb_mapped / 1048576.0));
+		if ( huge_arena.hugetlb_failures ) s.push_back(Stat("hugetlb_failures", "hugetlbfs fallbacks to THP", (int64_t)huge_arena.hugetlb_failures));
+		if ( anon >= 0 ) s.push_back(Stat("anon_huge_mb", "Transparent huge pages (MB)", anon / 1048576.0));
+	}
+	if ( perf.available ) {
+		uint64_t counts[PERF_EVENTS];
+		perf.read(counts);
+		for ( int e = 0; e < PERF_EVENTS; e++ ) counts[e] -= perf_start[e];
+		double n = propagations ? propagations : 1;
+		s.push_back(Stat("cycles", "Cycles", (int64_t)counts[PERF_CYCLES]));
+		s.push_back(Stat("instructions", "Instructions", (int64_t)counts[PERF_INSTRUCTIONS]));
+		s.push_back(Stat("ipc", "IPC", counts[PERF_CYCLES] ? (double)counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES] : 0.0));
+		s.push_back(Stat("llc_misses", "LLC misses", (int64_t)counts[PERF_LLC_MISSES]));
+		s.push_back(Stat("branch_misses", "Branch misses", (int64_t)counts[PERF_BRANCH_MISSES]));
+		s.push_back(Stat("dtlb_misses", "dTLB load misses", (int64_t)counts[PERF_DTLB_MISSES]));
+		s.push_back(Stat("llc_misses_per_propagation", "LLC misses per propagation", counts[PERF_LLC_MISSES] / n));
+		s.push_back(Stat("branch_misses_per_propagation", "Branch misses per propagation", counts[PERF_BRANCH_MISSES] / n));
+		s.push_back(Stat("dtlb_misses_per_propagation", "dTLB load misses per propagation", counts[PERF_DTLB_MISSES] / n));
+		if ( !profiler.perf ) s.push_back(Stat("perf_phases", "Perf per phase", "unavailable (rdpmc not allowed)"));
+	} else if ( perf_enabled ) {
+		static char why[128];
+		snprintf(why, sizeof(why), "unavailable (%s)", strerror(perf.error));
+		s.push_back(Stat("perf", "Perf", why));
+	}
+	if ( mode_switching ) {
+		s.push_back(Stat("mode_switches", "Mode switches", mode_switches));
+		s.push_back(Stat("focused_time", "Focused time", mode_time[MODE_FOCUSED]));
+		s.push_back(Stat("focused_conflicts", "Focused conflicts", mode_conflicts[MODE_FOCUSED]));
+		s.push_back(Stat("focused_decisions", "Focused decisions", mode_decides[MODE_FOCUSED]));
+		s.push_back(Stat("focused_propagations", "Focused propagations", mode_propagations[MODE_FOCUSED]));
+		s.push_back(Stat("focused_restarts", "Focused restarts", mode_restarts[MODE_FOCUSED]));
+		s.push_back(Stat("stable_time", "Stable time", mode_time[MODE_STABLE]));
+		s.push_back(Stat("stable_conflicts", "Stable conflicts", mode_conflicts[MODE_STABLE]));
+		s.push_back(Stat("stable_decisions", "Stable decisions", mode_decides[MODE_STABLE]));
+		s.push_back(Stat("stable_propagations", "Stable propagations", mode_propagations[MODE_STABLE]));
+		s.push_back(Stat("stable_restarts", "Stable restarts", mode_restarts[MODE_STABLE]));
+	}
+	PROFILE_REPORT(s);
+	stats.write("stats", s);
+}
+
+// Print a progress line
+void Solver::progress( double now ) {
+	double elapsed = now - last_progress;
+	int64_t learnts = clauseDB.size() - origin_clauses;
+
+	std::vector<Stat> s;
+	s.push_back(Stat("time", "time", now - solve_start));
+	s.push_back(Stat("conflicts", "conflicts", conflicts));
+	s.push_back(Stat("conflicts_per_second", "conflicts/s", (conflicts - last_conflicts) / elapsed));
+	s.push_back(Stat("propagations_per_second", "propagations/s", (propagations - last_propagations) / elapsed));
+	s.push_back(Stat("learnts", "learnts", learnts));
+	s.push_back(Stat("average_lbd", "lbd", conflicts ? (double)lbd_sum / conflicts : 0.0));
+	s.push_back(Stat("restarts", "restarts", restarts));
+	s.push_back(Stat("mode", "mode", mode == MODE_STABLE ? "stable" : "focused"));
+	s.push_back(Stat("memory_mb", "MB", peak_memory_mb()));
+	s.push_back(Stat("accounted_mb", "accounted MB", account_memory().total() / 1048576.0));
+	stats.write("progress", s);
+
+	last_progress = now;
+	last_conflicts = conflicts;
+	last_propagations = propagations;
+}
+
+// Add a record to the trace
+void Solver::trace_event( int event ) {
+	TraceRecord r;
+	r.event = event;
+	r.mode = mode;
+	r.reserved = 0, r.reserved2 = 0;
+	r.level = decVarInTrail.size();
+	r.conflicts = conflicts;
+	r.trail = trail.size();
+	r.learnts = clauseDB.size() - origin_clauses;
+	r.lbd_fast = lbd_fast.value;
+	r.lbd_slow = lbd_slow.value;
+	r.restarts = restarts;
+	r.reductions = reductions;
+	r.time = profile_wall() - trace_start;
+	trace.write(r);
+}
+
+// Update the bytes (live and peak) per data structure
+// Walks the clause database and the watcher lists, so it is called only at reduces and reports
+const MemoryAccount &Solver::account_memory() {
+	if ( value == NULL ) return memory;
+
+	// As allocated by initialize(): value (padded for the SIMD kernels), phases, level/reason/mark, activity
+	size_t n = vars + 1;
+	size_t bytes = (n + SIMD_PADDING) * sizeof(int8_t) + n * (3 * sizeof(int8_t) + sizeof(uint64_t));
+#ifdef VAR_AOS
+	bytes += n * sizeof(VarData);
+#else
+	bytes += n * (2 * sizeof(int) + sizeof(CRef));
+#endif
+	memory.set(MEM_VARIABLES, bytes + vector_bytes(dimacs_var));
+
+
+	bytes = vector_bytes(clauseDB);
+	for ( size_t i = 0; i < clauseDB.size(); i++ ) bytes += vector_bytes(clauseDB[i].literals);
+	memory.set(MEM_CLAUSES, bytes);
+
+	bytes = (2 * vars + 1) * sizeof(Watches);
+	memory.set(MEM_WATCHERS, bytes + watch_pool.bytes);
+	memory.peak_at(MEM_WATCHERS, bytes + watch_pool.peak);
+
+	memory.set(MEM_TRAIL, vector_bytes(trail) + vector_bytes(decVarInTrail) + vector_bytes(learnt) + vector_bytes(reduceMap));
+	memory.set(MEM_HEAP, vsids.memory());
+	memory.set(MEM_QUEUE, vmtf.memory());
+	return memory;
+}
+
+// Write a DRAT proof of UNSAT answers
+bool Solver::open_proof( const char *filename ) {
+	proof = fopen(filename, "w");
+	if ( proof == NULL ) return false;
+	setvbuf(proof, NULL, _IOFBF, 1 << 20);
+	return true;
+}
+
+// Add or delete a clause in the proof (size 0: the empty clause)
+void Solver::proof_clause( const int *lits, int size, bool deleted ) {
+	if ( deleted ) fputs("d ", proof);
+	for ( int i = 0; i < size; i++ ) fprintf(proof, "%d ", dimacs(lits[i]));
+	fputs("0\n", proof);
+}
+
 // Print model when the result is SAT
 void Solver::printModel() {
-    	for ( int i = 1; i <= vars; i++ ) printf("%d ", value[i] * i);
+	if ( dimacs_var.empty() ) for ( int i = 1; i <= vars; i++ ) printf("%d ", value[i] * i);
+	else {
+		// In the DIMACS numbering
+		std::vector<int8_t> model(vars + 1);
+		for ( int i = 1; i <= vars; i++ ) model[dimacs_var[i]] = value[i];
+		for ( int i = 1; i <= vars; i++ ) printf("%d ", model[i] * i);
+	}
     	printf( "0\n" );
 }
@@ -4,6 +4,19 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <vector>
+#include <algorithm>
+
+#include "restart.h"
+#include "profile.h"
+#include "stats.h"
+#include "trace.h"
+#include "memory.h"
+#include "perf.h"
+#include "probes.h"
+#include "simd.h"
+#include "huge.h"
+#include "watches.h"
+#include <signal.h>
 
 #define POLY_MASK_32 0xB4BCD35C
 #define POLY_MASK_31 0x7A5BC2E3
@@ -13,8 +26,56 @@
 #define Parent(x) ((x - 1) >> 1)
 
 #define Value(literal) (literal > 0 ? value[literal] : -value[-literal])
+#ifdef VAR_AOS
+#define Level(var) (var_data[var].level)
+#define Reason(var) (var_data[var].reason)
+#define Mark(var) (var_data[var].mark)
+#else
+#define Level(var) (level[var])
+#define Reason(var) (reason[var])
+#define Mark(var) (mark[var])
+#endif
 #define WatchedLiterals(id) (watched_literals[vars + id])
 
+// Largest number of variables: literals, watcher indices (vars + literal) and array sizes stay ints
+#define MAX_VARS ((INT_MAX - SIMD_PADDING - 1) / 2)
+
+// Software prefetching in propagate()
+// Build with -DPREFETCH=<distance> to prefetch the clauses of the watchers <distance>
+// positions ahead (header first, then the literals at half the distance) and the
+// watch list of the next trail literal. 0 disables it.
+#ifndef PREFETCH
+#define PREFETCH 0
+#endif
+
+// Clauses of this size or more take the long-clause path of propagate():
+// the replacement watch search resumes at the saved position and wraps around
+// (-DNO_SAVED_POS starts at c[2] every time), with the SIMD kernels of simd.h
+#ifndef LONG_CLAUSE
+#define LONG_CLAUSE 16
+#endif
+
+// Conflicts before the first reduce, mode switch (--mode=switch) and rephase
+// Build with smaller values (e.g. -DREDUCE_FIRST=100 -DMODE_FIRST=50 -DREPHASE_FIRST=200)
+// to reach them on small instances, as benchmark/fuzz.py does
+#ifndef REDUCE_FIRST
+#define REDUCE_FIRST 8192
+#endif
+#ifndef MODE_FIRST
+#define MODE_FIRST 1000
+#endif
+#ifndef REPHASE_FIRST
+#define REPHASE_FIRST 100000
+#endif
+
+// Decision heuristics
+#define DECIDE_VSIDS 0
+#define DECIDE_VMTF 1
+
+// Search modes
+#define MODE_FOCUSED 0
+#define MODE_STABLE 1
+
 
 // Heap data structure (max heap)
 class Heap {
@@ -57,8 +118,10 @@ class Heap {
     	}
 
 public:
-    	void initialize( const uint64_t *s ) {
+    	void initialize( const uint64_t *s, int n ) {
 		activity = s;
+		heap.reserve(n);
+		pos.assign(n + 1, -1);
 	}
 
     	bool empty() const { return heap.size() == 0; }
@@ -68,7 +131,6 @@ public:
 	void update( int x ) { up(pos[x]); }
 
     	void insert( int x ) {
-        	if ( (int)pos.size() < x + 1 ) pos.resize(x + 1, -1);	
 		pos[x] = heap.size();
         	heap.push_back(x);
         	up(pos[x]); 
@@ -83,89 +145,422 @@ public:
         	if ( heap.size() > 1 ) down(0);
         	return x; 
     	}
+
+	// Keys are read from activity directly
+	void decay() {}
+	void refresh() {}
+
+	// Allocated bytes
+	size_t memory() const { return vector_bytes(heap) + vector_bytes(pos); }
+};
+
+
+// d-ary heap data structure (max heap)
+// (activity, variable) pairs are stored contiguously,
+// so a sift step touches one array instead of heap, pos, and activity.
+// With D = 4, the children of a node fill exactly one 64-byte cache line.
+template <int D>
+class DHeap {
+	struct Entry {
+		uint64_t key;	// Copy of activity[var]
+		int var;
+	};
+
+	const uint64_t *activity;	// Pointer to activity database
+	std::vector<Entry> buffer;	// Storage of the heap (aligned by heap)
+	Entry *heap;			// heap[0] is the root
+	int size;			// The number of entries
+	std::vector<int> pos;		// Actual position of heap
+
+	void up( int v ) {
+		Entry x = heap[v];
+		while ( v ) {
+			int p = (v - 1) / D;
+			if ( heap[p].key >= x.key ) break;
+			heap[v] = heap[p];
+			pos[heap[v].var] = v;
+			v = p;
+		}
+		heap[v] = x;
+		pos[x.var] = v;
+	}
+
+	void down( int v ) {
+		Entry x = heap[v];
+		int c;
+		while ( (c = v * D + 1) < size ) {
+			// Pick the biggest one among the children
+			int end = c + D < size ? c + D : size;
+			int child = c;
+			for ( int i = c + 1; i < end; i++ ) if ( heap[i].key > heap[child].key ) child = i;
+			if ( x.key >= heap[child].key ) break;
+			heap[v] = heap[child];
+			pos[heap[v].var] = v;
+			v = child;
+		}
+		heap[v] = x;
+		pos[x.var] = v;
+	}
+
+public:
+	void initialize( const uint64_t *s, int n ) {
+		activity = s;
+		// Every variable is in the heap at most once, so no reallocation later
+		// Shift the heap so that the first child group starts at a cache line
+		int line = 64 / sizeof(Entry);
+		buffer.resize(n + line);
+		uintptr_t addr = (uintptr_t)(buffer.data() + 1);
+		heap = buffer.data() + ((64 - addr % 64) % 64) / sizeof(Entry);
+		size = 0;
+		pos.assign(n + 1, -1);
+	}
+
+	bool empty() const { return size == 0; }
+
+	bool inHeap( int n ) const { return pos[n] >= 0; }
+
+	// Activity of x has been increased
+	void update( int x ) {
+		heap[pos[x]].key = activity[x];
+		up(pos[x]);
+	}
+
+	void insert( int x ) {
+		pos[x] = size;
+		heap[size].key = activity[x];
+		heap[size].var = x;
+		size++;
+		up(pos[x]);
+	}
+
+	int pop() {
+		int x = heap[0].var;
+		heap[0] = heap[--size];
+		pos[heap[0].var] = 0;
+		pos[x] = -1;
+		if ( size > 1 ) down(0);
+		return x;
+	}
+
+	// Mirror var_decay (every non-zero activity minus one) on the keys
+	// Decreasing all the keys in the same order keeps the heap property
+	void decay() {
+		for ( int i = 0; i < size; i++ ) if ( heap[i].key ) heap[i].key--;
+	}
+
+	// Reload the keys after every activity was scaled down
+	void refresh() {
+		for ( int i = 0; i < size; i++ ) heap[i].key = activity[heap[i].var];
+	}
+
+	// Allocated bytes
+	size_t memory() const { return vector_bytes(buffer) + vector_bytes(pos); }
+};
+
+
+// A heap operation recorded from a real run (replayed by bench/heap.cpp)
+// 'n': initialize with var variables, 'i': insert, 'u': update, 'p': pop, 'd': decay, 'r': refresh
+struct HeapOp {
+	int op;
+	int var;
+	uint64_t activity;
 };
 
+#ifdef HEAP_TRACE
+// Heap recording every operation to "heap.trace"
+template <class H>
+class TracedHeap : public H {
+	const uint64_t *activity;
+	FILE *out;
+
+	void record( int op, int var ) {
+		HeapOp o = { op, var, var > 0 ? activity[var] : 0 };
+		fwrite(&o, sizeof(HeapOp), 1, out);
+	}
+
+public:
+	TracedHeap(): out(NULL) {}
+	~TracedHeap() { if ( out ) fclose(out); }
+
+	void initialize( const uint64_t *s, int n ) {
+		H::initialize(s, n);
+		activity = s;
+		out = fopen("heap.trace", "wb");
+		HeapOp o = { 'n', n, 0 };
+		fwrite(&o, sizeof(HeapOp), 1, out);
+	}
+	void update( int x ) { H::update(x); record('u', x); }
+	void insert( int x ) { H::insert(x); record('i', x); }
+	int pop() { int x = H::pop(); record('p', x); return x; }
+	void decay() { H::decay(); record('d', 0); }
+	void refresh() { H::refresh(); record('r', 0); }
+};
+#endif
+
+
+// Heap used by VSIDS
+// Build with -DHEAP_ARITY=4 to use the d-ary heap instead of the binary heap
+// Build with -DHEAP_TRACE to record the heap operations
+#ifdef HEAP_ARITY
+typedef DHeap<HEAP_ARITY> BaseHeap;
+#else
+typedef Heap BaseHeap;
+#endif
+#ifdef HEAP_TRACE
+typedef TracedHeap<BaseHeap> VarHeap;
+#else
+typedef BaseHeap VarHeap;
+#endif
+
+
+// Variable-move-to-front queue (VMTF) [Based on CaDiCaL]
+// A doubly linked list ordered by the time stamp of the last bump
+// The most recently bumped variable is at the end (last)
+class Queue {
+	std::vector<int> prev, next;	// Links of the list (0 means none)
+	std::vector<uint64_t> btab;	// Time stamp of the last enqueue of a variable
+	int first, last;		// The least and the most recently bumped variables
+	int search;			// Search cursor: all variables after it are assigned
+	uint64_t stamp;			// Time stamp counter
+
+	void dequeue( int v ) {
+		if ( prev[v] ) next[prev[v]] = next[v];
+		else first = next[v];
+		if ( next[v] ) prev[next[v]] = prev[v];
+		else last = prev[v];
+	}
+
+	void enqueue( int v ) {
+		prev[v] = last;
+		next[v] = 0;
+		if ( last ) next[last] = v;
+		else first = v;
+		last = v;
+		btab[v] = ++stamp;
+	}
+
+public:
+	void initialize( int vars ) {
+		prev.assign(vars + 1, 0);
+		next.assign(vars + 1, 0);
+		btab.assign(vars + 1, 0);
+		first = last = search = 0;
+		stamp = 0;
+		for ( int v = 1; v <= vars; v++ ) enqueue(v);
+		search = last;
+	}
+
+	uint64_t bumped( int v ) const { return btab[v]; }
+
+	// Move a variable to the front of the queue
+	void bump( int v, bool unassigned ) {
+		if ( v != last ) {
+			dequeue(v);
+			enqueue(v);
+		}
+		if ( unassigned ) search = v;
+	}
+
+	// A variable has been unassigned in backtracking
+	// Move the cursor if it was bumped more recently
+	void unassign( int v ) { if ( btab[v] > btab[search] ) search = v; }
+
+	// Restart the search from the most recently bumped variable
+	void reset_search() { search = last; }
+
+	// Walk from the cursor to the first unassigned variable (0 if none)
+	int pick( const int8_t *value ) {
+		int v = search;
+		while ( v && value[v] ) v = prev[v];
+		search = v;
+		return v;
+	}
+
+	// Allocated bytes
+	size_t memory() const { return vector_bytes(prev) + vector_bytes(next) + vector_bytes(btab); }
+};
+
+
+// Compressed original clauses (--compress)
+// Clauses of COMPRESS_MIN_SIZE or more literals keep the two watched literals as ints,
+// followed by the number of literals and all literals sorted by variable as varints
+// of (variable delta << 1 | sign): literals = { c[0], c[1], size, bytes... }
+// The encoding is never changed: a new watch is copied to c[1] and the old one stays in the bytes.
+#ifndef COMPRESS_MIN_SIZE
+#define COMPRESS_MIN_SIZE 8
+#endif
 
 // Clause
 class Clause {
 public:
 	// Literal block distance based on Glucose
 	// LBD = How many decision variable in a learnt clause
-    	int lbd;
+    	int lbd : 31;
+	// Compressed (see COMPRESS_MIN_SIZE)
+	unsigned packed : 1;
+	// Where the last replacement watch search stopped (long clauses only) [Based on Gent]
+	int pos;
     	// Literals in a clause
-	std::vector<int> literals;
+	std::vector<int, HugeAllocator<int> > literals;
 	// Overloading array operator
 	// Return a certain literal in a clause
     	int& operator [] ( int index ) { return literals[index]; }
+	// The number of literals
+	int size() const { return packed ? literals[2] : literals.size(); }
+	// Encoded literals of a compressed clause
+	const uint8_t *bytes() const { return (const uint8_t *)(literals.data() + 3); }
 	// Initialize literal block distance value as 0
 	// Resize literal array size
-    	Clause( int sz ): lbd(0) { literals.resize(sz); }
+    	Clause( int sz ): lbd(0), packed(0), pos(2) { literals.resize(sz); }
 };
 
+// Read a varint of a compressed clause
+static inline const uint8_t *read_varint( const uint8_t *p, uint32_t &x ) {
+	int shift = 0;
+	x = 0;
+	while ( *p & 0x80 ) x |= (uint32_t)(*p++ & 0x7f) << shift, shift += 7;
+	x |= (uint32_t)*p++ << shift;
+	return p;
+}
 
-// Watcher list
-class WL {
-public:
-	// Which clause a watched literal is included
-	// A index of a clause in ClauseDB
-    	int clauseIdx;
-	// A flag for check whether a clause is already satisfied or not
-    	int blocker;
-    	WL(): clauseIdx(0), blocker(0) {}
-    	WL( int c, int b ): clauseIdx(c), blocker(b) {}
+
+// Per-variable data read together in conflict analysis
+// Build with -DVAR_AOS to keep it in one record per variable (one cache line instead of three);
+// value stays a dense byte array for propagate()
+struct VarData {
+	CRef reason;		// The index of the clause that implies the variable assignment
+	int level;		// The decision level of a variable
+	int mark;		// Parameter for conflict analyzation
 };
 
 
+
+
 // Solver
 class Solver {
 public:
     	std::vector<int> learnt,                        // The index of the learnt clauses
                          trail,                         // Save the assigned literal sequence(phase saving)
-                         decVarInTrail,                 // Save the decision variables' position in trail(phase saving)
-                         reduceMap;                     // Data structure for reduce
-    	std::vector<Clause> clauseDB;                   // Clause database
-    	std::vector<WL> *watched_literals;              // A mapping from literal to clauses
+                         decVarInTrail;                 // Save the decision variables' position in trail(phase saving)
+	std::vector<CRef> reduceMap;			// Data structure for reduce
+    	std::vector<Clause, HugeAllocator<Clause> > clauseDB; // Clause database
+    	Watches *watched_literals;                      // A mapping from literal to clauses
+	WatchPool watch_pool;				// Storage of the watcher lists longer than WATCH_INLINE
     	
-	int vars, clauses, origin_clauses, conflicts;   // The number of variables, clauses, and conflicts
-	int decides, propagations;			// The number of decides and propagations
-    	int restarts, rephases, reduces;                // Parameters for restart, rephase, and reduce
-    	int rephase_inc, rephase_limit, reduce_limit;   // Parameters for rephase and reduce
+	int vars;					// The number of variables
+	int64_t clauses;				// The number of clauses in the header
+	CRef origin_clauses;				// The number of original clauses
+	int64_t conflicts, decides, propagations;	// The number of conflicts, decides, and propagations
+    	int64_t restarts, rephases, reductions;         // The number of restarts, rephases, and reduces
+	int64_t lbd_sum;				// Sum of the LBDs of all learnt clauses
+    	int reduces;                                    // Conflicts since the last reduce
+    	int64_t rephase_inc, rephase_limit;             // Parameters for rephase
+	int reduce_limit;                               // Parameter for reduce
     	int threshold;                                  // A threshold for updating the local_best phase
     	int propagated;                                 // The number of propagted literals in trail
-    	int time_stamp;                                 // Parameter for conflict analyzation and LBD calculation   
-   
-    	int lbd_queue[50],                              // Circled queue saved the recent 50 LBDs
-            lbd_queue_size,                             // The number of LBDs in this queue
-            lbd_queue_pos;                              // The position to save the next LBD
-    	int fast_lbd_sum, slow_lbd_sum;			// Sum of the global and recent 50 LBDs
+    	int time_stamp;                                 // Parameter for conflict analyzation and LBD calculation (marks are cleared before it wraps)   
+
+	int restart_kind[2];				// Restart policy per mode (RESTART_*)
+	bool block_restarts;				// Postpone restarts on large trails [Based on Glucose]
+	Restart *restarter[2];				// Restart policy per mode
+
+	int mode, mode_switching;			// Current search mode and whether to alternate modes
+	int64_t mode_inc, mode_limit;			// Parameters for switching modes
+	int64_t mode_switches;				// The number of mode switches
+	double mode_start;				// CPU time when the current mode was entered
+	int target_assigned;				// The largest trail since the last restart (target phase)
+	int64_t mode_conflicts[2], mode_decides[2];	// The number of conflicts and decides per mode
+	int64_t mode_propagations[2], mode_restarts[2];	// The number of propagations and restarts per mode
+	double mode_time[2];				// CPU time per mode
+	Profiler profiler;				// Time (-DPROFILE) and events (--perf) per phase of the solve loop
 
 	int8_t *value,					// The variable assignment (1:True; -1:False; 0:Undefine)
 	       *local_best,				// A pahse with a local deepest trail
-	       *saved;					// Phase saving
-        int *reason,                                    // The index of the clause that implies the variable assignment
-            *level,                                     // The decision level of a variable      
+	       *saved,					// Phase saving
+	       *target;					// Target phase for stable mode
+#ifdef VAR_AOS
+	VarData *var_data;				// level, reason and mark per variable (access with Level(), Reason(), Mark())
+#else
+        CRef *reason;                                   // The index of the clause that implies the variable assignment
+        int *level,                                     // The decision level of a variable      
             *mark;                                      // Parameter for conflict analyzation
+#endif
 
     	uint64_t *activity;				// The variables' score for VSIDS
-    	Heap vsids;					// Heap to select variable
+    	VarHeap vsids;					// Heap to select variable
+	Queue vmtf;					// Queue to select variable
+	int heuristic;					// Decision heuristic (DECIDE_VSIDS or DECIDE_VMTF)
+	int64_t conflict_limit;				// Stop with UNSOLVED after this many conflicts (0: no limit)
+	bool compress;					// Compress long original clauses (--compress)
+	int64_t packed_clauses;				// The number of compressed clauses
+	std::vector<int> unpacked;			// Literals of a compressed clause in analyze()
+	bool renumber;					// Renumber the variables after parsing (--renumber)
+	std::vector<int> dimacs_var;			// DIMACS number of each variable (empty: not renumbered)
+	bool relocate;					// Relocate the clauses in watch order at reduces (--relocate)
+	double distance_before[2], distance_after[2];	// Sums over reduces of watch_distance() (headers, literals)
+
+	FILE *proof;					// DRAT proof output (NULL: none)
+	int proof_units;				// Level 0 trail literals already in the proof
+
+	StatsWriter stats;				// Statistics output (text, JSON, or CSV)
+	double progress_interval;			// Seconds between progress lines (0: none)
+	double solve_start, last_progress;		// CPU time at the start of solve() (-1: not started) and of the last progress line
+	int64_t last_conflicts, last_propagations;	// Counters at the last progress line
+
+	Trace trace;					// Time series of the search (--trace)
+	Ema lbd_fast, lbd_slow;				// LBD averages for the trace
+	double trace_start;				// Wall clock at the start of solve()
+
+	MemoryAccount memory;				// Bytes per data structure (account_memory(), and add_clause() and the watch pool in between)
+
+	bool perf_enabled;				// Count hardware events over solve() (--perf)
+	PerfCounters perf;
+	uint64_t perf_start[PERF_EVENTS];		// Counts at the start of solve()
+
+	Solver();                                                 // Set default options
+	~Solver();                                                // Release all memory
+	Solver( const Solver & ) = delete;                        // The solver owns raw arrays
+	Solver &operator=( const Solver & ) = delete;
 
 	void initialize();                                        // Allocate memory and initialize the values 
-    	void assign( int literal, int level, int cref );          // Assign true value to a certain literal
-	int  add_clause( std::vector<int> &c );                   // Add new clause to clause database
-	int  propagate();                                         // BCP (Boolean Contraint Propagation)
+    	void assign( int literal, int level, CRef cref );         // Assign true value to a certain literal
+	CRef add_clause( std::vector<int> &c );                   // Add new clause to clause database
+	bool pack_clause( Clause &c, std::vector<int> &lits );    // Compress an original clause
+	bool add_input_clause( std::vector<int> &c );             // Add a clause of the input (false if UNSAT)
+	bool renumber_variables( std::vector<int> &lits );        // Renumber by locality and add the clauses
+	int  dimacs( int literal ) const {                        // A literal in the DIMACS numbering
+		if ( dimacs_var.empty() ) return literal;
+		return literal > 0 ? dimacs_var[literal] : -dimacs_var[-literal];
+	}
+	const int *clause_literals( Clause &c, int &size );       // Literals with the watches first (decoded if compressed)
+	CRef propagate();                                         // BCP (Boolean Contraint Propagation), the conflicting clause or -1
     	int  parse( char *filename );                             // Read CNF file
-	int  decide();                                            // Pick decision variable based on VSIDS
+	int  decide();                                            // Pick decision variable based on VSIDS or VMTF
 	void update_score( int var, uint64_t amount );		  // Update activity
-    	int  analyze( int cref, int &backtrack_level, int &lbd ); // Conflict analysis
+	void bump_queue( std::vector<int> &vars );		  // Move variables to the front of VMTF queue
+    	int  analyze( CRef cref, int &backtrack_level, int &lbd ); // Conflict analysis
 	void backtrack( int backtrack_level );                    // Backtracking
+	bool restarting();                                        // Check whether to restart in the current mode
     	void restart();                                           // Do restart
+	void switch_mode();                                       // Alternate focused and stable modes
     	void rephase();                                           // Do rephase
     	void reduce();                                            // Do reduce
+	void watch_distance( double &headers, double &literals ); // Average distance between the clauses of consecutive watchers
 	int  solve();                                             // Solver
     	void printModel();                                        // Print model when the result is SAT
+	void report( int res );                                   // Print statistics (every exit path)
+	void progress( double now );                              // Print a progress line
+	void trace_event( int event );                            // Add a record to the trace
+	const MemoryAccount &account_memory();                    // Update the bytes (live and peak) per data structure
+	bool open_proof( const char *filename );                  // Write a DRAT proof of UNSAT answers
+	void proof_clause( const int *lits, int size, bool deleted ); // Add or delete a clause in the proof
 };
 
 
+// Set by a signal handler to stop solve() with UNSOLVED
+extern volatile sig_atomic_t solver_interrupted;
+
+
 // Etc
 // rand() in stdlib
 uint32_t shift_lfsr( uint32_t *lfsr, uint32_t polynomial_mask );
@@ -174,3 +569,4 @@ uint32_t rand_generator();
 uint8_t *read_whitespace( uint8_t *p );
 uint8_t *read_until_new_line( uint8_t *p );
 uint8_t *read_int( uint8_t *p, int *i );
+uint8_t *read_int64( uint8_t *p, int64_t *i );
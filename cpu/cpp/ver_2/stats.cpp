@@ -0,0 +1,61 @@
+#include <string.h>
+#include <sys/resource.h>
+#include "stats.h"
+
+
+// Peak resident memory of this process in MB
+double peak_memory_mb() {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss / 1024.0;
+}
+
+// Write one record
+void StatsWriter::write( const char *type, const std::vector<Stat> &stats ) {
+	bool progress = !strcmp(type, "progress");
+	if ( format == STATS_NONE ) return;
+
+	if ( format == STATS_JSON ) {
+		printf( "{\"type\": \"%s\"", type );
+		for ( size_t k = 0; k < stats.size(); k++ ) {
+			const Stat &s = stats[k];
+			if ( s.type == 0 ) printf( ", \"%s\": %lld", s.key, (long long)s.i );
+			else if ( s.type == 1 ) printf( ", \"%s\": %.6g", s.key, s.d );
+			else printf( ", \"%s\": \"%s\"", s.key, s.s );
+		}
+		printf( "}\n" );
+	} else if ( format == STATS_CSV ) {
+		if ( !header[progress] ) {
+			printf( "type" );
+			for ( size_t k = 0; k < stats.size(); k++ ) printf( ",%s", stats[k].key );
+			printf( "\n" );
+			header[progress] = true;
+		}
+		printf( "%s", type );
+		for ( size_t k = 0; k < stats.size(); k++ ) {
+			const Stat &s = stats[k];
+			if ( s.type == 0 ) printf( ",%lld", (long long)s.i );
+			else if ( s.type == 1 ) printf( ",%.6g", s.d );
+			else printf( ",%s", s.s );
+		}
+		printf( "\n" );
+	} else if ( progress ) {
+		// A single line with the comment prefix of DIMACS
+		printf( "c" );
+		for ( size_t k = 0; k < stats.size(); k++ ) {
+			const Stat &s = stats[k];
+			if ( s.type == 0 ) printf( " %s %lld", s.label, (long long)s.i );
+			else if ( s.type == 1 ) printf( " %s %.2f", s.label, s.d );
+			else printf( " %s %s", s.label, s.s );
+		}
+		printf( "\n" );
+	} else {
+		for ( size_t k = 0; k < stats.size(); k++ ) {
+			const Stat &s = stats[k];
+			if ( s.type == 0 ) printf( "%s: %lld\n", s.label, (long long)s.i );
+			else if ( s.type == 1 ) printf( "%s: %.2f\n", s.label, s.d );
+			else printf( "%s: %s\n", s.label, s.s );
+		}
+	}
+	fflush(stdout);
+}
@@ -0,0 +1,46 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+// Statistics formats
+#define STATS_TEXT 0		// "Label: value" lines
+#define STATS_JSON 1		// One JSON object per line
+#define STATS_CSV 2		// A header line per record type, then value lines
+#define STATS_NONE 3		// Nothing
+
+
+// A named statistic (integer, real, or string)
+class Stat {
+public:
+	const char *key;	// Machine-readable name
+	const char *label;	// Name in text format
+	int type;		// 0: integer, 1: real, 2: string
+	int64_t i;
+	double d;
+	const char *s;
+
+	Stat( const char *k, const char *l, int64_t v ): key(k), label(l), type(0), i(v), d(0), s(NULL) {}
+	Stat( const char *k, const char *l, double v ): key(k), label(l), type(1), i(0), d(v), s(NULL) {}
+	Stat( const char *k, const char *l, const char *v ): key(k), label(l), type(2), i(0), d(0), s(v) {}
+};
+
+
+// Write records of statistics ("stats" at exit, "progress" periodically)
+class StatsWriter {
+	int format;
+	bool header[2];		// CSV header already written per record type
+public:
+	StatsWriter(): format(STATS_TEXT) { header[0] = header[1] = false; }
+	void set_format( int f ) { format = f; }
+	int get_format() const { return format; }
+	void write( const char *type, const std::vector<Stat> &stats );
+};
+
+
+// Peak resident memory of this process in MB
+double peak_memory_mb();
+
+#endif
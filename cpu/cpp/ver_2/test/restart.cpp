@@ -0,0 +1,62 @@
+// Decision level after restart() and rephase()
+// Both go back to level 0 with every restart policy; level 0 assignments are kept.
+//
+// Usage: ./obj/restart (exit status 1 on a failure)
+#include <string.h>
+#include <string>
+#include "../solver.h"
+#include "../bench/common.h"
+
+
+// Decide and propagate until the given level (false if a conflict or a model comes first)
+static bool descend( Solver &S, int levels ) {
+        while ( (int)S.decVarInTrail.size() < levels ) {
+                if ( S.propagate() != -1 || S.decide() == 10 ) return false;
+        }
+        return S.propagate() == -1;
+}
+
+static int failures = 0;
+
+static void check( const char *what, const char *policy, Solver &S, size_t level0_trail ) {
+        if ( S.decVarInTrail.size() != 0 || S.trail.size() != level0_trail ) {
+                printf( "FAIL %s (%s): level %zu, trail %zu (level 0: %zu)\n", what, policy,
+                        S.decVarInTrail.size(), S.trail.size(), level0_trail );
+                failures++;
+        }
+        else printf( "ok   %s (%s)\n", what, policy );
+}
+
+
+int main() {
+        // Under-constrained, so descents are deep; a unit clause for level 0
+        std::string filename = write_temp(random_cnf(500, 2.0, 1));
+        const char *policies[5] = { "queue", "ema", "luby", "geometric", "reluctant" };
+        int kinds[5] = { RESTART_QUEUE, RESTART_EMA, RESTART_LUBY, RESTART_GEOMETRIC, RESTART_RELUCTANT };
+        for ( int k = 0; k < 5; k++ ) {
+                Solver S;
+                S.stats.set_format(STATS_NONE);
+                S.restart_kind[MODE_FOCUSED] = S.restart_kind[MODE_STABLE] = kinds[k];
+                if ( S.parse((char *)filename.c_str()) == 20 || S.propagate() != -1 ) {
+                        printf( "FAIL instance is UNSAT at level 0\n" );
+                        return 1;
+                }
+                size_t level0_trail = S.trail.size();
+
+                if ( !descend(S, 10) ) {
+                        printf( "FAIL no descent to level 10 (%s)\n", policies[k] );
+                        return 1;
+                }
+                S.restart();
+                check("restart", policies[k], S, level0_trail);
+
+                if ( !descend(S, 10) ) {
+                        printf( "FAIL no descent to level 10 (%s)\n", policies[k] );
+                        return 1;
+                }
+                S.rephase();
+                check("rephase", policies[k], S, level0_trail);
+        }
+        remove(filename.c_str());
+        return failures ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+// Buffer size (records are written when it is full and at the end)
+#define TRACE_BUFFER (1 << 20)
+
+
+bool Trace::open( const char *filename, int f, int64_t k ) {
+	close();
+	file = fopen(filename, f == TRACE_BINARY ? "wb" : "w");
+	if ( file == NULL ) return false;
+	format = f;
+	interval = k > 0 ? k : 1;
+	next = interval;
+	buffer = (char *)malloc(TRACE_BUFFER);
+	used = 0;
+
+	if ( format == TRACE_BINARY ) {
+		uint32_t size = sizeof(TraceRecord);
+		fwrite("SATTRACE", 1, 8, file);
+		fwrite(&size, sizeof(size), 1, file);
+	} else {
+		fprintf( file, "event,mode,conflicts,time,level,trail,learnts,lbd_fast,lbd_slow,restarts,reductions\n" );
+	}
+	return true;
+}
+
+void Trace::write( const TraceRecord &r ) {
+	if ( file == NULL ) return;
+	if ( used + 256 > TRACE_BUFFER ) flush();
+
+	if ( format == TRACE_BINARY ) {
+		memcpy(buffer + used, &r, sizeof(r));
+		used += sizeof(r);
+	} else {
+		const char *names[6] = { "sample", "restart", "rephase", "reduce", "mode", "end" };
+		used += snprintf(buffer + used, TRACE_BUFFER - used, "%s,%s,%lld,%.6f,%d,%d,%lld,%.3f,%.3f,%lld,%lld\n",
+				 names[r.event], r.mode ? "stable" : "focused", (long long)r.conflicts, r.time,
+				 r.level, r.trail, (long long)r.learnts, r.lbd_fast, r.lbd_slow,
+				 (long long)r.restarts, (long long)r.reductions);
+	}
+}
+
+void Trace::flush() {
+	if ( file == NULL ) return;
+	fwrite(buffer, 1, used, file);
+	fflush(file);
+	used = 0;
+}
+
+void Trace::close() {
+	if ( file == NULL ) return;
+	flush();
+	fclose(file);
+	free(buffer);
+	file = NULL;
+	buffer = NULL;
+}
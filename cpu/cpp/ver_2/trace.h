@@ -0,0 +1,63 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Time series of the search for post-mortem analysis
+// A sample every K conflicts and a record per restart, rephase, reduce and mode switch,
+// collected in a buffer and written in large blocks
+
+// Trace formats
+#define TRACE_CSV 0		// A header line, then one line per record
+#define TRACE_BINARY 1		// "SATTRACE" magic and record size, then TraceRecord structs
+
+// Record events
+#define EVENT_SAMPLE 0
+#define EVENT_RESTART 1
+#define EVENT_REPHASE 2
+#define EVENT_REDUCE 3
+#define EVENT_MODE 4		// Mode switch (mode is the new mode)
+#define EVENT_END 5		// End of the search
+
+
+// One record (64 bytes, little endian in binary traces)
+// Counters are 64-bit as in the solver; level and trail are bounded by the variables (MAX_VARS)
+struct TraceRecord {
+	uint8_t event;		// EVENT_*
+	uint8_t mode;		// MODE_FOCUSED or MODE_STABLE
+	uint16_t reserved;
+	int32_t level;		// Decision level
+	int64_t conflicts;
+	int64_t learnts;	// Learnt clauses in the database
+	int64_t restarts;
+	int64_t reductions;
+	int32_t trail;		// Trail size
+	float lbd_fast;		// LBD exponential moving averages (1/32, 1/4096)
+	float lbd_slow;
+	uint32_t reserved2;
+	double time;		// Wall clock seconds since the start of solve()
+};
+
+
+class Trace {
+	FILE *file;
+	int format;
+	char *buffer;		// Records not yet written
+	size_t used;
+public:
+	int64_t interval;	// Conflicts between samples (0: trace disabled)
+	int64_t next;		// Conflicts at the next sample
+
+	Trace(): file(NULL), format(TRACE_CSV), buffer(NULL), used(0), interval(0), next(0) {}
+	~Trace() { close(); }
+
+	// Returns false if the file cannot be created
+	bool open( const char *filename, int format, int64_t interval );
+	bool enabled() const { return file != NULL; }
+	void write( const TraceRecord &r );
+	void flush();
+	void close();
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include <string.h>
+#include "watches.h"
+#include "huge.h"
+
+
+// Size class of a block for n watchers (capacity 4 << k)
+static inline int watch_class( int n ) {
+	return n <= 4 ? 0 : 30 - __builtin_clz(n - 1);
+}
+
+
+WatchPool::WatchPool(): top(NULL), end(NULL), bytes(0), peak(0) {
+	for ( int k = 0; k < WATCH_CLASSES; k++ ) free_list[k] = NULL;
+}
+
+WatchPool::~WatchPool() {
+	reset();
+}
+
+// Release all slabs and large blocks
+void WatchPool::reset() {
+	HugeAllocator<WL> a;
+	for ( size_t i = 0; i < slabs.size(); i++ ) a.deallocate(slabs[i], WATCH_SLAB);
+	for ( size_t i = 0; i < large.size(); i++ ) a.deallocate(large[i], (size_t)4 << large_class[i]);
+	slabs.clear(), large.clear(), large_class.clear();
+	for ( int k = 0; k < WATCH_CLASSES; k++ ) free_list[k] = NULL;
+	top = end = NULL;
+	bytes = 0;
+}
+
+WL *WatchPool::allocate( int k ) {
+	size_t n = (size_t)4 << k;
+	if ( n > WATCH_LARGE ) {
+		WL *block = HugeAllocator<WL>().allocate(n);
+		large.push_back(block), large_class.push_back(k);
+		bytes += n * sizeof(WL);
+		if ( bytes > peak ) peak = bytes;
+		return block;
+	}
+	if ( free_list[k] ) {
+		WL *block = free_list[k];
+		free_list[k] = *(WL **)block;
+		return block;
+	}
+	// The rest of the current slab is left unused
+	if ( top == NULL || top + n > end ) {
+		top = HugeAllocator<WL>().allocate(WATCH_SLAB);
+		end = top + WATCH_SLAB;
+		slabs.push_back(top);
+		bytes += WATCH_SLAB * sizeof(WL);
+		if ( bytes > peak ) peak = bytes;
+	}
+	WL *block = top;
+	top += n;
+	return block;
+}
+
+void WatchPool::release( WL *block, int k ) {
+	size_t n = (size_t)4 << k;
+	if ( n > WATCH_LARGE ) {
+		for ( size_t i = large.size(); i-- > 0; ) {
+			if ( large[i] != block ) continue;
+			large[i] = large.back(), large.pop_back();
+			large_class[i] = large_class.back(), large_class.pop_back();
+			break;
+		}
+		HugeAllocator<WL>().deallocate(block, n);
+		bytes -= n * sizeof(WL);
+		return;
+	}
+	*(WL **)block = free_list[k];
+	free_list[k] = block;
+}
+
+void WatchPool::grow( Watches &ws ) {
+	int k = ws.items == ws.local ? 0 : watch_class(ws.cap) + 1;
+	WL *block = allocate(k);
+	memcpy(block, ws.items, ws.count * sizeof(WL));
+	if ( ws.items != ws.local ) release(ws.items, k - 1);
+	ws.items = block;
+	ws.cap = 4 << k;
+}
+
+void WatchPool::compact( Watches *lists, int n ) {
+	// Old storage stays readable until every list is copied
+	std::vector<WL *> old_slabs, old_large;
+	std::vector<int> old_large_class;
+	old_slabs.swap(slabs), old_large.swap(large), old_large_class.swap(large_class);
+	top = end = NULL;
+	for ( int k = 0; k < WATCH_CLASSES; k++ ) free_list[k] = NULL;
+	size_t old_bytes = bytes;
+	bytes = 0;
+
+	for ( int i = 0; i < n; i++ ) {
+		Watches &ws = lists[i];
+		if ( ws.items == ws.local ) continue;
+		WL *from = ws.items;
+		if ( ws.count <= WATCH_INLINE ) {
+			ws.items = ws.local;
+			ws.cap = WATCH_INLINE;
+		}
+		else {
+			int k = watch_class(ws.count);
+			ws.items = allocate(k);
+			ws.cap = 4 << k;
+		}
+		memcpy(ws.items, from, ws.count * sizeof(WL));
+	}
+	if ( old_bytes + bytes > peak ) peak = old_bytes + bytes;
+
+	HugeAllocator<WL> a;
+	for ( size_t i = 0; i < old_slabs.size(); i++ ) a.deallocate(old_slabs[i], WATCH_SLAB);
+	for ( size_t i = 0; i < old_large.size(); i++ ) a.deallocate(old_large[i], (size_t)4 << old_large_class[i]);
+}
@@ -0,0 +1,100 @@
+#ifndef WATCHES_H
+#define WATCHES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+
+// Watcher lists in pooled storage
+// The list of a literal is a 32-byte header (Watches, 48 with INDEX64) that holds up to WATCH_INLINE
+// watchers itself.
+// Longer lists move to blocks of 4 << k watchers from the solver's WatchPool:
+//  - blocks up to WATCH_LARGE watchers are cut from slabs of WATCH_SLAB watchers and recycled
+//    through a free list per size class
+//  - larger blocks are allocated one by one
+// Slabs and large blocks come from huge_arena, so --huge applies to them.
+// compact() copies all lists into fresh slabs in literal order and releases the old ones (at reduces).
+
+#define WATCH_INLINE 2
+#define WATCH_SLAB (1 << 17)
+#define WATCH_LARGE (WATCH_SLAB / 8)
+#define WATCH_CLASSES 30
+
+// Clause reference: the index of a clause in the clause database
+// int by default; build with -DINDEX64 for more than 2^31 - 1 clauses (watchers grow to 16 bytes)
+#ifdef INDEX64
+typedef int64_t CRef;
+#define CREF_MAX INT64_MAX
+#else
+typedef int CRef;
+#define CREF_MAX INT_MAX
+#endif
+
+
+// Watcher
+class WL {
+public:
+	// Which clause a watched literal is included
+	// A index of a clause in ClauseDB
+    	CRef clauseIdx;
+	// A flag for check whether a clause is already satisfied or not
+    	int blocker;
+    	WL(): clauseIdx(0), blocker(0) {}
+    	WL( CRef c, int b ): clauseIdx(c), blocker(b) {}
+};
+
+class WatchPool;
+
+// Watcher list of a literal
+// Not copyable: the watchers may be stored in the header
+class Watches {
+	WL *items;			// local or a block of the pool
+	int count, cap;
+	WL local[WATCH_INLINE];
+	friend class WatchPool;
+public:
+	Watches(): items(local), count(0), cap(WATCH_INLINE) {}
+	Watches( const Watches & ) = delete;
+	Watches &operator=( const Watches & ) = delete;
+
+	int size() const { return count; }
+	int capacity() const { return cap; }
+	WL *data() { return items; }
+	WL &operator[]( int i ) { return items[i]; }
+	const WL &operator[]( int i ) const { return items[i]; }
+	// Keep the first n watchers
+	void shrink( int n ) { count = n; }
+	inline void push_back( const WL &w, WatchPool &pool );
+};
+
+
+class WatchPool {
+	WL *free_list[WATCH_CLASSES];	// Released blocks per size class
+	WL *top, *end;			// Unused part of the current slab
+	std::vector<WL *> slabs;
+	std::vector<WL *> large;	// Large blocks and their size classes
+	std::vector<int> large_class;
+
+	WL *allocate( int k );
+	void release( WL *block, int k );
+	void reset();
+public:
+	size_t bytes;			// Bytes of the slabs and large blocks
+	size_t peak;			// Largest bytes so far (old and new storage during compact())
+
+	WatchPool();
+	~WatchPool();
+
+	// Move a full list to a block of twice its capacity
+	void grow( Watches &ws );
+	// Copy the lists into fresh slabs (blocks fitted to their sizes, short lists back into their headers)
+	void compact( Watches *lists, int n );
+};
+
+inline void Watches::push_back( const WL &w, WatchPool &pool ) {
+	if ( count == cap ) pool.grow(*this);
+	items[count++] = w;
+}
+
+#endif